@@ -0,0 +1,88 @@
+; Block programming helper for the JBug11 talker (polling build, IntType $02)
+
+; Loaded by TBug11 (helper=) into free RAM above the talker.  For each block TBug11 writes the
+; data to Buf and the parameters below with the talker's memory write command ($41), then starts
+; the helper by writing its start address over the operand of the talker's NullSrv jump
+; (JMP sci_srv), which the talker runs as soon as that write command finishes.  The polling
+; talker returns from its register write command ($C1) with the same jump instead of an RTI, so
+; that command cannot start code.
+
+; Each byte is erased (EEPROM only) and programmed with a 10ms pulse, then compared.  The helper
+; restores the NullSrv jump, sends the count of bytes that did not match to the host and
+; returns to the talker's receive wait loop.
+
+; TBug11 expects the parameters at the start, followed by the code, then Buf.  Needs a 512 byte
+; or larger RAM, the 256 byte RAM has no room for it next to the talker.
+
+RegBase		EQU	$1000		; Base address for control registers
+SCSR		EQU	RegBase+$2E	; SCI status register
+SCDR		EQU	RegBase+$2F	; SCI data register
+PPROG		EQU	RegBase+$3B	; EEPROM/EPROM programming control register
+
+sci_srv		EQU	$000F		; Talker receive wait loop
+NullJmp		EQU	$0055		; Operand of the talker's NullSrv JMP sci_srv
+
+; The delay loop (SUBD = 4 & BNE = 3) takes 7 cycles, with an 8MHz crystal and 2MHz E clock
+; (0.5us) a counter value for a delay of 10ms is: 10000us/3.5us = 2857 (truncated)
+DelayAmt	EQU	20000/7
+
+		ORG	$0100
+
+; Parameters, written by the host for each block
+
+HReg		FDB	PPROG		; Programming register, PPROG or EPROG ($1036, E20)
+HAddr		FDB	$0000		; Address of the first byte
+HCount		FCB	$00		; Byte count, 0 = 256
+HErase		FCB	$16		; Byte erase latch value: EELAT, ERASE and BYTE.  0 = no erase (EPROM)
+HProg		FCB	$02		; Program latch value: EELAT (EEPROM) or ELAT ($20, EPROM)
+HStatus		FCB	$00		; Bytes that did not match
+
+HStart		LDY	HAddr		; Y = memory address
+		LDX	#Buf		; X = data address
+		CLR	HStatus
+
+HLoop		LDAA	$00,X		; Fetch data byte
+		LDAB	HErase
+		BEQ	HNoErase	; branch if EPROM
+		BSR	Pulse		; Erase the byte
+HNoErase	LDAB	HProg
+		BSR	Pulse		; Program the byte
+
+		CMPA	$00,Y		; Verify it
+		BEQ	HNext
+		INC	HStatus
+
+HNext		INX			; Next byte
+		INY
+		DEC	HCount
+		BNE	HLoop		; until all done
+
+; Restore the talker and report the status
+
+		LDD	#sci_srv
+		STD	NullJmp		; Restore the NullSrv jump
+
+HTxWait		LDAA	SCSR		; Wait for the transmit data register to empty
+		BPL	HTxWait
+		LDAA	HStatus
+		STAA	SCDR		; Send the status to host
+		JMP	sci_srv		; Return to the talker
+
+; Pulse the programming register.  A = data byte, B = latch value, Y = memory address
+
+Pulse		PSHX
+		LDX	HReg
+		STAB	$00,X		; Enable the latch
+		STAA	$00,Y		; Store data byte at the address, this latches it for programming
+		INCB
+		STAB	$00,X		; Enable programming (EPGM = 1)
+		PSHA
+		LDD	#DelayAmt
+PWait		SUBD	#$0001		; [4]
+		BNE	PWait		; [3]
+		CLR	$00,X		; Disable the latch and programming
+		PULA
+		PULX
+		RTS
+
+Buf		EQU	*		; Data block, up to the top of RAM less the talker's stack
@@ -12,7 +12,8 @@
 	item(APP_ERROR_XFER_INFO_ID, "Requested {} byte(s) but {} transferred") \
 	item(APP_ERROR_ECHO_ID, "Echo failed") \
 	item(APP_ERROR_ECHO_INFO_ID, "Transmitted 0x{:02x} but received 0x{:02x}") \
-	item(APP_ERROR_TALKER_TOO_BIG_ID, "Talker control program is larger than {} bytes")
+	item(APP_ERROR_TALKER_TOO_BIG_ID, "Talker control program is larger than {} bytes") \
+	item(APP_ERROR_HELPER_RAM_ID, "Block programming helper and its buffer do not fit in {} bytes RAM")
 
 // Create enum from error message list
 CREATE_ENUM(app_error_e, APP_ERROR_LIST)
@@ -70,6 +70,9 @@ void usage(char *arg_0){
 	printf("devparams:\n");
 	printf("  path=<s>       : serial port path\n");
 	printf("  [timeout=<n>]  : timeout ms\n");
+	printf("  [helper=<s>]   : write_ee/write_e/write_e20 with the block programming helper file (JBug_Prog.s19),\n");
+	printf("                   loaded into RAM above the talker, it programs and verifies a block at a time on-chip\n");
+	printf("  [ram=<n>]      : RAM size, default 256.  The helper needs 512 or more\n");
 	printf("\n");
 	printf("cmdparams:\n");
 	printf("uptalker        : upload talker\n");
@@ -136,6 +139,12 @@ bool parse_params_search(char *cmdl_param, cl_my_params *my_params){
 	if(parse_param_str(cmdl_param, "talker=", my_params->talker_filename)){
 		return true;
 	}
+	if(parse_param_str(cmdl_param, "helper=", my_params->helper_filename)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "ram=", my_params->ram_size)){
+		return true;
+	}
 	if(parse_param_yn(cmdl_param, "fast=", my_params->use_fast)){
 		return true;
 	}
@@ -25,9 +25,11 @@ public:
 	uint32_t serial_rxbuf_size;
 	uint32_t serial_txbuf_size;
 	uint32_t timeoutms;
+	uint32_t ram_size;
 	uint8_t srec_datalen;
 	bool verify_config;
 	std::string talker_filename;
+	std::string helper_filename;
 	std::string full_file_name;
 	std::string data;
 	uint32_t from_addr;
@@ -39,6 +41,7 @@ public:
 		serial_rxbuf_size(256),  // If the serial driver is using no buffers, set this to 2 or 1
 		serial_txbuf_size(256),  // If the serial driver is using no buffers, set this to 2 or 1
 		timeoutms(1000),
+		ram_size(256),
 		srec_datalen(16),
 		verify_config(false),
 		talker_filename("JBug_Talk.s19"),
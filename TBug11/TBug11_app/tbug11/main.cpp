@@ -60,6 +60,7 @@
 #include "my_file.h"
 #include <stdio.h>
 #include <iostream>
+#include <vector>
 #include <format>
 
 // For the Sleep/sleep function
@@ -71,11 +72,19 @@
 
 #define BOOTLOADER_MAX_BYTE_COUNT 256
 #define TALKER_MAX_BYTE_COUNT 256
-// The talker is too slow so we don't need a delay (typically 10ms)
-#define TALKER_ERASE_PROG_DELAY 0
+// EEPROM erase/program and EPROM program time in ms.  The register writes are streamed in batches, so the talker is no
+// longer too slow to need it and the batch is padded with null commands for the delay
+#define TALKER_ERASE_PROG_DELAY 10
+#define TALKER_BAUD 9600
 #define TALKER_READ_CMD 0x01
 #define TALKER_WRITE_CMD 0x41
+#define TALKER_NULL_CMD 0xff  // Not a talker command, the talker only echoes its complement
 #define HC11_CONFIG_ADDR 0X103f
+#define HC11_EPROG_ADDR 0x1036  // MC68HC711E20 only
+#define HC11_PPROG_ADDR 0x103b
+#define JBUG_NULLSRV_JMP_ADDR 0x0055  // Operand of the talker's NullSrv JMP sci_srv, see JBug_Talk.lst
+#define JBUG_STACK_RESERVE 32  // Top of RAM left for a talker assembled with its stack there (E series)
+#define HELPER_PARAM_LEN 8  // Parameters at the start of the block programming helper, see JBug_Prog.asm
 #define SREC_ADDR_CHECKSUM_COUNT 3
 
 enum class talker_echo_e{
@@ -84,6 +93,23 @@ enum class talker_echo_e{
 	TALKER_ECHO_VERIFY
 };
 
+// Talker commands built into one transmit buffer, streamed in one go with the echoes checked afterwards.  The talker
+// handles each byte as it arrives, so a batch takes the same line time as the commands sent one at a time without
+// waiting for each echo
+typedef struct{
+	std::vector<uint8_t> txbuf;
+	std::vector<uint32_t> rx_counts;  // Bytes the talker sends after receiving each transmitted byte
+	std::vector<uint8_t> echo_txbytes;  // For each received byte, the transmitted byte it echoes
+	std::vector<talker_echo_e> echo_checks;  // For each received byte, how it is checked
+}talker_batch;
+
+// The block programming helper loaded in RAM, see JBug_Prog.asm
+typedef struct{
+	uint16_t addr;  // Load address, the parameters are first then the code
+	uint16_t buf_addr;  // Data block after the code
+	uint32_t buf_len;
+}prog_helper;
+
 // Generic transmit in blocks
 void tx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint32_t arg_len){
 	uint8_t *txbuf_p = arg_txbuf;
@@ -352,6 +378,103 @@ void writemem_byte(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_
 	txrx_chunk(arg_params, arg_serial_com, txbuf, rxbuf, 1, talker_echo_e::TALKER_ECHO_VERIFY);
 }
 
+void batch_add_tx(talker_batch *arg_batch, uint8_t arg_txbyte){
+	arg_batch->txbuf.push_back(arg_txbyte);
+	arg_batch->rx_counts.push_back(0);
+}
+
+// Add a byte the talker sends after receiving the last transmitted byte
+void batch_add_rx(talker_batch *arg_batch, uint8_t arg_txbyte, talker_echo_e arg_echo_check){
+	arg_batch->rx_counts.back()++;
+	arg_batch->echo_txbytes.push_back(arg_txbyte);
+	arg_batch->echo_checks.push_back(arg_echo_check);
+}
+
+// Add a memory write command of up to TALKER_MAX_BYTE_COUNT bytes
+void batch_writemem(talker_batch *arg_batch, uint16_t arg_addr, const uint8_t *arg_buf, uint32_t arg_len){
+	batch_add_tx(arg_batch, TALKER_WRITE_CMD);
+	batch_add_rx(arg_batch, TALKER_WRITE_CMD, talker_echo_e::TALKER_ECHO_VERIFY_COM);
+	batch_add_tx(arg_batch, (uint8_t)arg_len);  // Byte count
+	batch_add_tx(arg_batch, (uint8_t)(arg_addr >> 8 & 0xff));  // High byte of address
+	batch_add_tx(arg_batch, (uint8_t)(arg_addr & 0xff));  // Low byte of address
+	for(uint32_t i = 0; i < arg_len; i++){
+		batch_add_tx(arg_batch, arg_buf[i]);
+		batch_add_rx(arg_batch, arg_buf[i], talker_echo_e::TALKER_ECHO_VERIFY);
+	}
+}
+
+// Add the commands of writemem_byte()
+void batch_writemem_byte(talker_batch *arg_batch, uint16_t arg_addr, uint8_t value){
+	batch_writemem(arg_batch, arg_addr, &value, 1);
+}
+
+// Add a delay of null commands, each takes one byte time on the line
+void batch_delay(talker_batch *arg_batch, uint32_t arg_ms){
+	uint32_t count = (arg_ms * (TALKER_BAUD / 10) + 999) / 1000;  // 10 bits per byte
+
+	for(uint32_t i = 0; i < count; i++){
+		batch_add_tx(arg_batch, TALKER_NULL_CMD);
+		batch_add_rx(arg_batch, TALKER_NULL_CMD, talker_echo_e::TALKER_ECHO_VERIFY_COM);
+	}
+}
+
+// Transmit a batch in blocks, receiving the talker's replies to each block before the next, then check the echoes
+// The replies are returned in arg_rxbuf and the batch is cleared
+void batch_send(cl_my_params *arg_params, serial_com *arg_serial_com, talker_batch *arg_batch, std::vector<uint8_t> &arg_rxbuf){
+	uint32_t txpos = 0;
+	uint32_t rxpos = 0;
+	uint32_t chunklen;
+	uint32_t rxlen;
+	uint32_t i;
+
+	arg_rxbuf.resize(arg_batch->echo_txbytes.size());
+	while(txpos < arg_batch->txbuf.size()){
+		chunklen = ((uint32_t)arg_batch->txbuf.size() - txpos > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : (uint32_t)arg_batch->txbuf.size() - txpos;
+		tx_chunk(arg_params, arg_serial_com, arg_batch->txbuf.data() + txpos, chunklen);
+
+		rxlen = 0;
+		for(i = txpos; i < txpos + chunklen; i++){
+			rxlen += arg_batch->rx_counts[i];
+		}
+		rx_chunk(arg_params, arg_serial_com, arg_rxbuf.data() + rxpos, rxlen);
+
+		txpos += chunklen;
+		rxpos += rxlen;
+	}
+
+	for(i = 0; i < arg_rxbuf.size(); i++){
+		switch(arg_batch->echo_checks[i]){
+			case talker_echo_e::TALKER_ECHO_VERIFY: verify_echo(&arg_batch->echo_txbytes[i], &arg_rxbuf[i], 1); break;
+			case talker_echo_e::TALKER_ECHO_VERIFY_COM: verify_echo_com(&arg_batch->echo_txbytes[i], &arg_rxbuf[i], 1); break;
+			case talker_echo_e::TALKER_ECHO_IGNORE: break;
+		}
+	}
+
+	arg_batch->txbuf.clear();
+	arg_batch->rx_counts.clear();
+	arg_batch->echo_txbytes.clear();
+	arg_batch->echo_checks.clear();
+}
+
+// Read a chunk of memory with one transmission of the command, parameters and the acknowledgement of each byte
+void readmem_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t *arg_rxbuf, uint32_t arg_len){
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
+
+	batch_add_tx(&batch, TALKER_READ_CMD);
+	batch_add_rx(&batch, TALKER_READ_CMD, talker_echo_e::TALKER_ECHO_VERIFY_COM);
+	batch_add_tx(&batch, (uint8_t)arg_len);
+	batch_add_tx(&batch, (uint8_t)(arg_addr >> 8 & 0xff));
+	batch_add_tx(&batch, (uint8_t)(arg_addr & 0xff));
+	for(uint32_t i = 0; i < arg_len; i++){
+		batch_add_rx(&batch, 0, talker_echo_e::TALKER_ECHO_IGNORE);  // Memory byte, sent before the talker waits for its acknowledgement
+		batch_add_tx(&batch, TALKER_NULL_CMD);  // Acknowledgement (any byte), a null command if the talker is not reading
+	}
+
+	batch_send(arg_params, arg_serial_com, &batch, rxbuf);
+	memcpy(arg_rxbuf, rxbuf.data() + 1, arg_len);
+}
+
 // Switch to Special Test mode, RBOOT = 0, IRV = 0.  This enables config register programming and also access to external memory areas
 void test_mode(cl_my_params *arg_params, serial_com *arg_serial_com){
 	writemem_byte(arg_params, arg_serial_com, 0x103c, 0x66);  // Write HPRIO ($103c) with 0x66
@@ -368,99 +491,236 @@ void bprot_on(cl_my_params *arg_params, serial_com *arg_serial_com){
 }
 
 // Write EEPROM byte.  Assumes address was already erased
-void eeprom_prog_byte(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t address,  uint8_t byte){
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x02);   // Enable EEPROM latch: EELAT = 1
-	writemem_byte(arg_params, arg_serial_com, address, byte);  // Store data byte at EEPROM address.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x03);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch) and EPGM = 1 (Enable programming)
+void eeprom_prog_byte(talker_batch *arg_batch, uint16_t address,  uint8_t byte){
+	batch_writemem_byte(arg_batch, 0x103b, 0x02);   // Enable EEPROM latch: EELAT = 1
+	batch_writemem_byte(arg_batch, address, byte);  // Store data byte at EEPROM address.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
+	batch_writemem_byte(arg_batch, 0x103b, 0x03);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch) and EPGM = 1 (Enable programming)
 
-	// Delay
-#if defined(WIN32) || defined(WIN64)
-	if(TALKER_ERASE_PROG_DELAY != 0) Sleep(TALKER_ERASE_PROG_DELAY);
-#else
-	if(TALKER_ERASE_PROG_DELAY != 0) sleep(TALKER_ERASE_PROG_DELAY / 1000);
-#endif
+	batch_delay(arg_batch, TALKER_ERASE_PROG_DELAY);
 
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage: EELAT = 0 (Disable EEPROM latch) and EPGM = 0 (Disable programming)
+	batch_writemem_byte(arg_batch, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage: EELAT = 0 (Disable EEPROM latch) and EPGM = 0 (Disable programming)
 }
 
 // Bulk erase (erase all).  Note, the passed in byte is a dummy and not actually programmed
-void eeprom_bulk_erase(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t address,  uint8_t byte){
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x06);   // Enable EEPROM latch and bulk erase mode: EELAT = 1 (enable EEPROM latch) and ERASE = 1 (bulk erase mode)
-	writemem_byte(arg_params, arg_serial_com, address, byte);  // Store data byte at EEPROM address.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x07);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch), EPGM = 1 (Enable programming) and ERASE = 1 (bulk erase mode)
+void eeprom_bulk_erase(talker_batch *arg_batch, uint16_t address,  uint8_t byte){
+	batch_writemem_byte(arg_batch, 0x103b, 0x06);   // Enable EEPROM latch and bulk erase mode: EELAT = 1 (enable EEPROM latch) and ERASE = 1 (bulk erase mode)
+	batch_writemem_byte(arg_batch, address, byte);  // Store data byte at EEPROM address.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
+	batch_writemem_byte(arg_batch, 0x103b, 0x07);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch), EPGM = 1 (Enable programming) and ERASE = 1 (bulk erase mode)
 
-	// Delay
-#if defined(WIN32) || defined(WIN64)
-	if(TALKER_ERASE_PROG_DELAY != 0) Sleep(TALKER_ERASE_PROG_DELAY);
-#else
-	if(TALKER_ERASE_PROG_DELAY != 0) sleep(TALKER_ERASE_PROG_DELAY / 1000);
-#endif
+	batch_delay(arg_batch, TALKER_ERASE_PROG_DELAY);
 
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
+	batch_writemem_byte(arg_batch, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
 }
 
 // Row erase (16 bytes).  Note, the passed in byte is a dummy and not actually programmed
-void eeprom_row_erase(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t address,  uint8_t byte){
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x0e);   // Enable EEPROM latch and row erase mode: EELAT = 1 (enable EEPROM latch), ERASE =1 (erase mode) and ROW = 1 (row erase mode)
-	writemem_byte(arg_params, arg_serial_com, address, byte);  // Store data byte to EEPROM address in row.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x0f);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch), EPGM = 1 (Enable programming), ERASE =1 (erase mode) and ROW = 1 (row erase mode)
+void eeprom_row_erase(talker_batch *arg_batch, uint16_t address,  uint8_t byte){
+	batch_writemem_byte(arg_batch, 0x103b, 0x0e);   // Enable EEPROM latch and row erase mode: EELAT = 1 (enable EEPROM latch), ERASE =1 (erase mode) and ROW = 1 (row erase mode)
+	batch_writemem_byte(arg_batch, address, byte);  // Store data byte to EEPROM address in row.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
+	batch_writemem_byte(arg_batch, 0x103b, 0x0f);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch), EPGM = 1 (Enable programming), ERASE =1 (erase mode) and ROW = 1 (row erase mode)
 
-	// Delay
-#if defined(WIN32) || defined(WIN64)
-	if(TALKER_ERASE_PROG_DELAY != 0) Sleep(TALKER_ERASE_PROG_DELAY);
-#else
-	if(TALKER_ERASE_PROG_DELAY != 0) sleep(TALKER_ERASE_PROG_DELAY / 1000);
-#endif
+	batch_delay(arg_batch, TALKER_ERASE_PROG_DELAY);
 
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
+	batch_writemem_byte(arg_batch, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
 }
 
 // Byte erase.  Note, the passed in byte is a dummy and not actually programmed
-void eeprom_byte_erase(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t address,  uint8_t byte){
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x16);   // Enable EEPROM latch and byte erase mode: EELAT = 1 (enable EEPROM latch), ERASE =1 (erase mode) and BYTE = 1 (byte erase mode)
-	writemem_byte(arg_params, arg_serial_com, address, byte);  // Store dummy data byte to EEPROM address
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x17);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch), EPGM = 1 (Enable programming), ERASE =1 (erase mode) and BYTE = 1 (byte erase mode)
+void eeprom_byte_erase(talker_batch *arg_batch, uint16_t address,  uint8_t byte){
+	batch_writemem_byte(arg_batch, 0x103b, 0x16);   // Enable EEPROM latch and byte erase mode: EELAT = 1 (enable EEPROM latch), ERASE =1 (erase mode) and BYTE = 1 (byte erase mode)
+	batch_writemem_byte(arg_batch, address, byte);  // Store dummy data byte to EEPROM address
+	batch_writemem_byte(arg_batch, 0x103b, 0x17);   // Enable programming.  For EEPROM, this turns on programming voltage: EELAT = 1 (Enable EEPROM latch), EPGM = 1 (Enable programming), ERASE =1 (erase mode) and BYTE = 1 (byte erase mode)
 
-	// Delay
-#if defined(WIN32) || defined(WIN64)
-	if(TALKER_ERASE_PROG_DELAY != 0) Sleep(TALKER_ERASE_PROG_DELAY);
-#else
-	if(TALKER_ERASE_PROG_DELAY != 0) sleep(TALKER_ERASE_PROG_DELAY / 1000);
-#endif
+	batch_delay(arg_batch, TALKER_ERASE_PROG_DELAY);
 
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
+	batch_writemem_byte(arg_batch, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
 }
 
 // Write EPROM byte using PPROG register (0x103b).  Assumes address is FFs (unwritten)
-void eprom_prog_byte(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t address,  uint8_t byte){
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x20);   // Enable EPROM latch (ELAT = 1)
-	writemem_byte(arg_params, arg_serial_com, address, byte);  // Store data byte to EEPROM address in row.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x21);   // Enable programming.  For EPROM (excluding MC68HC711E20), this turns on programming voltage: ELAT = 1 (Enable EPROM latch) and EPGM = 1 (Enable programming)
+void eprom_prog_byte(talker_batch *arg_batch, uint16_t address,  uint8_t byte){
+	batch_writemem_byte(arg_batch, 0x103b, 0x20);   // Enable EPROM latch (ELAT = 1)
+	batch_writemem_byte(arg_batch, address, byte);  // Store data byte to EEPROM address in row.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
+	batch_writemem_byte(arg_batch, 0x103b, 0x21);   // Enable programming.  For EPROM (excluding MC68HC711E20), this turns on programming voltage: ELAT = 1 (Enable EPROM latch) and EPGM = 1 (Enable programming)
 
-	// Delay
-#if defined(WIN32) || defined(WIN64)
-	if(TALKER_ERASE_PROG_DELAY != 0) Sleep(TALKER_ERASE_PROG_DELAY);
-#else
-	if(TALKER_ERASE_PROG_DELAY != 0) sleep(TALKER_ERASE_PROG_DELAY / 1000);
-#endif
+	batch_delay(arg_batch, TALKER_ERASE_PROG_DELAY);
 
-	writemem_byte(arg_params, arg_serial_com, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
+	batch_writemem_byte(arg_batch, 0x103b, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
 }
 
 // Write EPROM byte for MC68HC711E20 using EPROG register (0x1036).  Assumes address is FFs (unwritten).  Requires 12V on VPPE pin
-void eprom_prog_e20_byte(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t address,  uint8_t byte){
-	writemem_byte(arg_params, arg_serial_com, 0x1036, 0x20);   // Enable EPROM latch (ELAT = 1)
-	writemem_byte(arg_params, arg_serial_com, address, byte);  // Store data byte to EEPROM address in row.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
-	writemem_byte(arg_params, arg_serial_com, 0x1036, 0x21);   // Enable programming: ELAT = 1 (Enable EPROM latch) and EPGM = 1 (Enable programming)
+void eprom_prog_e20_byte(talker_batch *arg_batch, uint16_t address,  uint8_t byte){
+	batch_writemem_byte(arg_batch, 0x1036, 0x20);   // Enable EPROM latch (ELAT = 1)
+	batch_writemem_byte(arg_batch, address, byte);  // Store data byte to EEPROM address in row.  Writing this byte latches (toggles) the circuit for programming, but not actually started yet
+	batch_writemem_byte(arg_batch, 0x1036, 0x21);   // Enable programming: ELAT = 1 (Enable EPROM latch) and EPGM = 1 (Enable programming)
 
-	// Delay
-#if defined(WIN32) || defined(WIN64)
-	if(TALKER_ERASE_PROG_DELAY != 0) Sleep(TALKER_ERASE_PROG_DELAY);
-#else
-	if(TALKER_ERASE_PROG_DELAY != 0) sleep(TALKER_ERASE_PROG_DELAY / 1000);
-#endif
+	batch_delay(arg_batch, TALKER_ERASE_PROG_DELAY);
+
+	batch_writemem_byte(arg_batch, 0x1036, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
+}
+
+// Load the block programming helper into RAM, its buffer is the rest of the RAM up to the talker's stack
+void load_helper(cl_my_params *arg_params, serial_com *arg_serial_com, prog_helper *arg_helper){
+	cl_my_file helper_file;
+	std::string line_str;
+	std::vector<uint8_t> image;
+	uint8_t srec_datacount;
+	uint32_t i;
+	uint32_t chunklen;
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
+
+	std::cout << "Loading " << arg_params->helper_filename << std::endl;
+	helper_file.open_file(arg_params->helper_filename, "rb");
+	do{
+		line_str.clear();
+		helper_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			if(image.empty()){
+				arg_helper->addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
+			}
+			srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+			for(i = 0; i < srec_datacount; i++){
+				image.push_back((uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16));
+			}
+		}
+	}while(!helper_file.eof());
+
+	if(image.size() <= HELPER_PARAM_LEN || arg_helper->addr + image.size() + JBUG_STACK_RESERVE >= arg_params->ram_size){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_HELPER_RAM_ID, std::format(app_error_string::messages[APP_ERROR_HELPER_RAM_ID], arg_params->ram_size), "");
+	}
+	arg_helper->buf_addr = (uint16_t)(arg_helper->addr + image.size());
+	arg_helper->buf_len = arg_params->ram_size - JBUG_STACK_RESERVE - arg_helper->buf_addr;
+	if(arg_helper->buf_len > TALKER_MAX_BYTE_COUNT){
+		arg_helper->buf_len = TALKER_MAX_BYTE_COUNT;
+	}
+
+	for(i = 0; i < image.size(); i += chunklen){
+		chunklen = ((uint32_t)image.size() - i > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : (uint32_t)image.size() - i;
+		batch_writemem(&batch, (uint16_t)(arg_helper->addr + i), image.data() + i, chunklen);
+	}
+	batch_send(arg_params, arg_serial_com, &batch, rxbuf);
+}
+
+// Program a piece of up to the buffer size with the helper.  arg_erase is the byte erase latch value, 0 for EPROM
+// Returns the bytes that did not match
+uint8_t helper_prog(cl_my_params *arg_params, serial_com *arg_serial_com, prog_helper *arg_helper, uint16_t arg_addr, const uint8_t *arg_buf, uint32_t arg_len, uint16_t arg_reg, uint8_t arg_erase, uint8_t arg_prog){
+	uint16_t start_addr = (uint16_t)(arg_helper->addr + HELPER_PARAM_LEN);
+	uint8_t param_buf[HELPER_PARAM_LEN] = {
+		(uint8_t)(arg_reg >> 8 & 0xff), (uint8_t)(arg_reg & 0xff),
+		(uint8_t)(arg_addr >> 8 & 0xff), (uint8_t)(arg_addr & 0xff),
+		(uint8_t)arg_len, arg_erase, arg_prog, 0
+	};
+	uint8_t start_buf[2] = { (uint8_t)(start_addr >> 8 & 0xff), (uint8_t)(start_addr & 0xff) };
+	uint8_t status;
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
+
+	batch_writemem(&batch, arg_helper->buf_addr, arg_buf, arg_len);
+	batch_writemem(&batch, arg_helper->addr, param_buf, HELPER_PARAM_LEN);
+	batch_writemem(&batch, JBUG_NULLSRV_JMP_ADDR, start_buf, 2);  // The talker jumps to the helper as this write finishes
+	batch_send(arg_params, arg_serial_com, &batch, rxbuf);
+
+	// The helper replies once it has programmed and verified every byte
+	arg_serial_com->set_timeout(arg_params->timeoutms + arg_len * (arg_erase ? 2 : 1) * TALKER_ERASE_PROG_DELAY);
+	rx_chunk(arg_params, arg_serial_com, &status, 1);
+	arg_serial_com->set_timeout(arg_params->timeoutms);
+
+	return status;
+}
+
+// Write a block of S-record data with the helper, in pieces of up to its buffer size, and show the result
+// Returns the bytes that did not match
+uint32_t helper_write_block(cl_my_params *arg_params, serial_com *arg_serial_com, prog_helper *arg_helper, uint16_t arg_addr, std::vector<uint8_t> &arg_block, uint16_t arg_reg, uint8_t arg_erase, uint8_t arg_prog){
+	uint32_t pos = 0;
+	uint32_t len;
+	uint16_t addr;
+	uint32_t mismatch_count = 0;
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
 
-	writemem_byte(arg_params, arg_serial_com, 0x1036, 0x00);  // Disable EEPROM latch and programming.  For EEPROM, this turns off programming voltage
+	std::cout << string_utils_ns::to_string_right_hex_up(arg_addr, 4, '0') << ":";
+	for(pos = 0; pos < arg_block.size(); pos++){
+		std::cout << string_utils_ns::to_string_right_hex_up((uint16_t)arg_block[pos], 2, '0');
+	}
+
+	pos = 0;
+	while(pos < arg_block.size()){
+		addr = (uint16_t)(arg_addr + pos);
+		if(arg_erase && addr == HC11_CONFIG_ADDR){
+			// As write_ee(), the new value cannot be read until a reset so it is not verified
+			eeprom_bulk_erase(&batch, addr, arg_block[pos]);  // Bulk erase instead of byte erase for compatibility with  A1, A8 and A2 series
+			eeprom_prog_byte(&batch, addr, arg_block[pos]);
+			batch_send(arg_params, arg_serial_com, &batch, rxbuf);
+			pos++;
+			continue;
+		}
+
+		len = ((uint32_t)arg_block.size() - pos > arg_helper->buf_len) ? arg_helper->buf_len : (uint32_t)arg_block.size() - pos;
+		if(addr < HC11_CONFIG_ADDR && addr + len > HC11_CONFIG_ADDR){
+			len = HC11_CONFIG_ADDR - addr;
+		}
+		mismatch_count += helper_prog(arg_params, arg_serial_com, arg_helper, addr, arg_block.data() + pos, len, arg_reg, arg_erase, arg_prog);
+		pos += len;
+	}
+
+	if(mismatch_count){
+		std::cout << " = " << mismatch_count << " mismatched" << std::endl;
+	}else{
+		std::cout << " = " << arg_block.size() << " matched" << std::endl;
+	}
+
+	return mismatch_count;
+}
+
+// Write a file to EEPROM/EPROM with the block programming helper, contiguous S1 records are merged into blocks of up to
+// the helper's buffer size.  arg_reg is PPROG or EPROG (E20), arg_erase the byte erase latch value (0 for EPROM) and
+// arg_prog the program latch value
+void writemem_helper_file(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_reg, uint8_t arg_erase, uint8_t arg_prog){
+	prog_helper helper;
+	cl_my_file in_file;
+	std::string line_str;
+	uint8_t srec_datacount;
+	uint16_t srec_addr;
+	std::vector<uint8_t> block;
+	uint16_t block_addr = 0;
+	uint32_t total_databytes = 0;
+	uint32_t mismatch_count = 0;
+	uint32_t i;
+
+	load_helper(arg_params, arg_serial_com, &helper);
+
+	in_file.open_file(arg_params->full_file_name, "rb");
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;  // Extract srecord data byte count
+			srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);  // Extract srecord address
+
+			// Write the block when this record cannot be appended to it
+			if(!block.empty() && ((uint16_t)(block_addr + block.size()) != srec_addr || block.size() + srec_datacount > helper.buf_len)){
+				mismatch_count += helper_write_block(arg_params, arg_serial_com, &helper, block_addr, block, arg_reg, arg_erase, arg_prog);
+				block.clear();
+			}
+			if(block.empty()){
+				block_addr = srec_addr;
+			}
+
+			for(i = 0; i < srec_datacount; i++){
+				block.push_back((uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16));
+			}
+			total_databytes += srec_datacount;
+		}
+	}while(!in_file.eof());
+
+	// Write the last block
+	if(!block.empty()){
+		mismatch_count += helper_write_block(arg_params, arg_serial_com, &helper, block_addr, block, arg_reg, arg_erase, arg_prog);
+	}
+
+	if(mismatch_count){
+		std::cout << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched" << std::endl;
+	}else{
+		std::cout << "PASSED. " << total_databytes << " total bytes" << std::endl;
+	}
 }
 
 void readmem(cl_my_params *arg_params, serial_com *arg_serial_com){
@@ -474,13 +734,9 @@ void readmem(cl_my_params *arg_params, serial_com *arg_serial_com){
 	uint8_t checksum = 0;
 	uint32_t chunklen = 0;
 	uint32_t remaining;
-	cl_my_buf txbuf;
-	uint8_t *txbuf_p;
 	cl_my_buf rxbuf;
 	uint8_t *rxbuf_p;
 
-	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	txbuf_p = txbuf.get_buf();
 	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
 	rxbuf_p = rxbuf.get_buf();
 
@@ -508,19 +764,7 @@ void readmem(cl_my_params *arg_params, serial_com *arg_serial_com){
 			chunklen = (remaining > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : remaining;
 
 			rxbuf_p = rxbuf.get_buf();
-
-			// Transmit command
-			txbuf_p[0] = TALKER_READ_CMD;
-			txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, 1, talker_echo_e::TALKER_ECHO_VERIFY_COM);
-
-			// Transmit parameters
-			txbuf_p[0] = (uint8_t)chunklen;
-			txbuf_p[1] = (uint8_t)(addr >> 8 & 0xff);
-			txbuf_p[2] = (uint8_t)(addr & 0xff);
-			tx_chunk(arg_params, arg_serial_com, txbuf_p, 3);
-
-			// Optimised method: Making use of driver buffering, if we transmit first and then receive a chunk, we get a huge speed up!
-			txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, chunklen, talker_echo_e::TALKER_ECHO_IGNORE);
+			readmem_chunk(arg_params, arg_serial_com, addr, rxbuf_p, chunklen);
 
 			remaining -= chunklen;
 		}
@@ -605,13 +849,9 @@ void readmem_verify(cl_my_params *arg_params, serial_com *arg_serial_com){
 	uint32_t mismatch_count = 0;
 	uint32_t line_ignore_count;
 	uint32_t ignore_count = 0;
-	cl_my_buf txbuf;
-	uint8_t *txbuf_p;
 	cl_my_buf rxbuf;
 	uint8_t *rxbuf_p;
 
-	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	txbuf_p = txbuf.get_buf();
 	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
 	rxbuf_p = rxbuf.get_buf();
 
@@ -633,19 +873,7 @@ void readmem_verify(cl_my_params *arg_params, serial_com *arg_serial_com){
 				line_mismatch_count = 0;
 				line_ignore_count = 0;
 				rxbuf_p = rxbuf.get_buf();
-
-				// Transmit command
-				txbuf_p[0] = TALKER_READ_CMD;
-				txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, 1, talker_echo_e::TALKER_ECHO_VERIFY_COM);
-
-				// Transmit parameters
-				txbuf_p[0] = (uint8_t)srec_datacount;
-				txbuf_p[1] = (uint8_t)(srec_addr >> 8 & 0xff);
-				txbuf_p[2] = (uint8_t)(srec_addr & 0xff);
-				tx_chunk(arg_params, arg_serial_com, txbuf_p, 3);
-
-				// Optimised method: Making use of driver buffering, if we transmit first and then receive a chunk, we get a huge speed up!
-				txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, srec_datacount, talker_echo_e::TALKER_ECHO_IGNORE);
+				readmem_chunk(arg_params, arg_serial_com, srec_addr, rxbuf_p, srec_datacount);
 
 				// Loop each data byte
 				for(i = 0; i < srec_datacount; i++){
@@ -807,6 +1035,8 @@ void write_ee(cl_my_params *arg_params, serial_com *arg_serial_com){
 	uint8_t srec_datacount;
 	uint16_t srec_addr;
 	uint8_t txbyte;
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
 
 	in_file.open_file(arg_params->full_file_name, "rb");
 
@@ -830,16 +1060,19 @@ void write_ee(cl_my_params *arg_params, serial_com *arg_serial_com){
 					std::cout << string_utils_ns::to_string_right_hex_up((uint16_t)(txbyte), 2, '0');
 
 					if(srec_addr == HC11_CONFIG_ADDR){
-						eeprom_bulk_erase(arg_params, arg_serial_com, srec_addr, txbyte);  // Bulk erase instead of byte erase for compatibility with  A1, A8 and A2 series
+						eeprom_bulk_erase(&batch, srec_addr, txbyte);  // Bulk erase instead of byte erase for compatibility with  A1, A8 and A2 series
 					}else{
-						eeprom_byte_erase(arg_params, arg_serial_com, srec_addr, txbyte);
+						eeprom_byte_erase(&batch, srec_addr, txbyte);
 					}
-					eeprom_prog_byte(arg_params, arg_serial_com, srec_addr, txbyte);
+					eeprom_prog_byte(&batch, srec_addr, txbyte);
 
 					srec_addr++;
 					bytecount++;
 				}
 				std::cout << std::endl;
+
+				// Stream the record's register/data sequences
+				batch_send(arg_params, arg_serial_com, &batch, rxbuf);
 			}
 		}
 	}while(!in_file.eof());
@@ -854,6 +1087,8 @@ void write_e(cl_my_params *arg_params, serial_com *arg_serial_com){
 	uint8_t srec_datacount;
 	uint16_t srec_addr;
 	uint8_t txbyte;
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
 
 	in_file.open_file(arg_params->full_file_name, "rb");
 
@@ -874,11 +1109,14 @@ void write_e(cl_my_params *arg_params, serial_com *arg_serial_com){
 				for(i = 0; i < srec_datacount; i++){
 					txbyte = (uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
 
-					eprom_prog_byte(arg_params, arg_serial_com, srec_addr, txbyte);
+					eprom_prog_byte(&batch, srec_addr, txbyte);
 
 					srec_addr++;
 					bytecount++;
 				}
+
+				// Stream the record's register/data sequences
+				batch_send(arg_params, arg_serial_com, &batch, rxbuf);
 			}
 		}
 	}while(!in_file.eof());
@@ -893,6 +1131,8 @@ void write_e20(cl_my_params *arg_params, serial_com *arg_serial_com){
 	uint8_t srec_datacount;
 	uint16_t srec_addr;
 	uint8_t txbyte;
+	talker_batch batch;
+	std::vector<uint8_t> rxbuf;
 
 	in_file.open_file(arg_params->full_file_name, "rb");
 
@@ -913,11 +1153,14 @@ void write_e20(cl_my_params *arg_params, serial_com *arg_serial_com){
 				for(i = 0; i < srec_datacount; i++){
 					txbyte = (uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
 
-					eprom_prog_e20_byte(arg_params, arg_serial_com, srec_addr, txbyte);
+					eprom_prog_e20_byte(&batch, srec_addr, txbyte);
 
 					srec_addr++;
 					bytecount++;
 				}
+
+				// Stream the record's register/data sequences
+				batch_send(arg_params, arg_serial_com, &batch, rxbuf);
 			}
 		}
 	}while(!in_file.eof());
@@ -1002,7 +1245,11 @@ bool process_cmd_line(cl_my_params *arg_params){
 				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);
 				std::cout << "Writing EEPROM" << std::endl;
 				bprot_off(arg_params, &serial);
-				write_ee(arg_params, &serial);
+				if(!arg_params->helper_filename.empty()){
+					writemem_helper_file(arg_params, &serial, HC11_PPROG_ADDR, 0x16, 0x02);  // Byte erase EELAT|ERASE|BYTE, program EELAT
+				}else{
+					write_ee(arg_params, &serial);
+				}
 				bprot_on(arg_params, &serial);
 			}
 
@@ -1011,7 +1258,11 @@ bool process_cmd_line(cl_my_params *arg_params){
 			if(prog_prompt_write(CMD_WRITE_EPROM)){
 				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);
 				std::cout << "Writing EPROM (non E20)" << std::endl;
-				write_e(arg_params, &serial);
+				if(!arg_params->helper_filename.empty()){
+					writemem_helper_file(arg_params, &serial, HC11_PPROG_ADDR, 0x00, 0x20);  // Program ELAT
+				}else{
+					write_e(arg_params, &serial);
+				}
 			}
 
 			break;
@@ -1019,7 +1270,11 @@ bool process_cmd_line(cl_my_params *arg_params){
 			if(prog_prompt_write(CMD_WRITE_EPROM_E20)){
 				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);
 				std::cout << "Writing EPROM (E20, 12V)" << std::endl;
-				write_e20(arg_params, &serial);
+				if(!arg_params->helper_filename.empty()){
+					writemem_helper_file(arg_params, &serial, HC11_EPROG_ADDR, 0x00, 0x20);  // Program ELAT
+				}else{
+					write_e20(arg_params, &serial);
+				}
 			}
 
 			break;
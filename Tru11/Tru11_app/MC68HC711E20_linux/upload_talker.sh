@@ -9,5 +9,5 @@ function cleanup {
 trap cleanup EXIT
 
 source env_linux.sh
-$APP uptalker path=$SERIALPATH fast=n
+$APP uptalker path=$SERIALPATH fast=n ram=768
 if [ $SHLVL -eq 1 ]; then read -n 1 -s -r -p "Press any key to continue"; fi
@@ -2,7 +2,7 @@
 CALL env_win.bat
 
 :: Run
-SET runcmd=%APP% uptalker path=%SERIALPATH% fast=y
+SET runcmd=%APP% uptalker path=%SERIALPATH% fast=y ram=768
 ECHO %runcmd%
 %runcmd% & IF %errorlevel% NEQ 0 GOTO :err_handler
 
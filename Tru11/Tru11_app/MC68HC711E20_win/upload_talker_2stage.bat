@@ -0,0 +1,18 @@
+@ECHO OFF
+CALL env_win.bat
+
+:: Run
+SET runcmd=%APP% uptalker path=%SERIALPATH% fast=y ram=768 loader=loader.s19
+ECHO %runcmd%
+%runcmd% & IF %errorlevel% NEQ 0 GOTO :err_handler
+
+:: Pause if run from double-click
+IF /I %0 EQU "%~dpnx0" PAUSE
+
+GOTO :end_of_script
+
+:err_handler
+:: Pause if run from double-click
+IF /I %0 EQU "%~dpnx0" PAUSE
+
+:end_of_script
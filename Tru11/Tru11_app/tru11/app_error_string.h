@@ -13,7 +13,41 @@
 	item(APP_ERROR_ECHO_ID, "Echo failed") \
 	item(APP_ERROR_ECHO_INFO_ID, "Transmitted 0x{:02x} but received 0x{:02x}") \
 	item(APP_ERROR_TALKER_TOO_BIG_ID, "Talker control program is larger than {} bytes") \
-	item(APP_ERROR_ALREADY_DL_ID, "Talker already downloaded")
+	item(APP_ERROR_ALREADY_DL_ID, "Talker already downloaded") \
+	item(APP_ERROR_TALKER_NO_REPLY_ID, "Talker did not reply") \
+	item(APP_ERROR_DAEMON_ID, "Daemon mode is only supported on Linux") \
+	item(APP_ERROR_JOB_FAILED_ID, "Job step failed") \
+	item(APP_ERROR_MCU_ID, "Unknown MCU {}, use one of {}") \
+	item(APP_ERROR_MCU_NEEDED_ID, "Option needs an MCU profile, use mcu=") \
+	item(APP_ERROR_MEM_TYPE_ID, "Address 0x{:04x} is {} on the {}, it cannot be written with this command") \
+	item(APP_ERROR_EPROM_CMD_ID, "The {} EPROM must be written with {}") \
+	item(APP_ERROR_PULSE_ID, "Adaptive EPROM pulses need pulse_max= from 1 to 255 and a talker assembled with RamSize > 256") \
+	item(APP_ERROR_BLOCK_ID, "Block writes need a talker assembled with RamSize > 512") \
+	item(APP_ERROR_SYNC_ID, "Sync needs file= and a talker assembled with RamSize > 256") \
+	item(APP_ERROR_FRAME_RAM_ID, "Framed mode needs a talker assembled with RamSize > 512") \
+	item(APP_ERROR_FRAME_ID, "Framed header reply is neither ACK nor NAK") \
+	item(APP_ERROR_FRAME_INFO_ID, "Sequence number 0x{:02x} but received 0x{:02x}") \
+	item(APP_ERROR_FRAME_RETRY_ID, "Framed transfer still failed after {} retries") \
+	item(APP_ERROR_RAM_SIZE_ID, "RAM size {} is not supported, use 256, 512, 768 or 1024") \
+	item(APP_ERROR_RLE_ID, "Run-length decode failed") \
+	item(APP_ERROR_RLE_INFO_ID, "Repeat count {} is more than the {} byte(s) remaining") \
+	item(APP_ERROR_SESSION_CMD_ID, "A session write must be write, write_ee, write_e or write_e20") \
+	item(APP_ERROR_MDROP_ID, "Multi-drop needs a talker assembled with MultiDrop set and RamSize > 512") \
+	item(APP_ERROR_MDROP_UNITS_ID, "Unit address {} is not from 1 to 254") \
+	item(APP_ERROR_MDROP_UNIT_ID, "Unit(s) {} did not reply") \
+	item(APP_ERROR_MDROP_PULSE_ID, "Adaptive EPROM pulses cannot be broadcast, each MCU may need a different pulse count") \
+	item(APP_ERROR_NOT_BLANK_ID, "EPROM is not blank at 0x{:04x}, it reads 0x{:02x}.  Use blank=n to program it anyway") \
+	item(APP_ERROR_MEMTEST_ID, "Memory tests need a talker assembled with RamSize > 512 and MultiDrop not set") \
+	item(APP_ERROR_MEMTEST_RANGE_ID, "Memory test range 0x{:04x}-0x{:04x} is not valid") \
+	item(APP_ERROR_MEMTEST_REG_ID, "Memory test range includes the registers at 0x{:04x}-0x{:04x}") \
+	item(APP_ERROR_CALL_ID, "Calling a routine needs a talker assembled with RamSize > 512 and MultiDrop not set") \
+	item(APP_ERROR_ROUTINE_ID, "Routine uploaded to 0x{:04x} did not read back, the RAM below the talker's stack is not working") \
+	item(APP_ERROR_PLAN_FILES_ID, "write_all needs the image files, use files=") \
+	item(APP_ERROR_PLAN_OVERLAP_ID, "{} and {} both have address 0x{:04x}") \
+	item(APP_ERROR_CMD_FAILED_ID, "Command failed") \
+	item(APP_ERROR_DAEMON_REQUEST_ID, "The daemon does not run this request, give one command (not daemon or job=) or status or quit") \
+	item(APP_ERROR_TALKER_PATCH_ID, "Control program at 0x{:04x} with {} bytes has no timing parameters to patch for {} baud, it must start at 0x0000") \
+	item(APP_ERROR_SESSION_RANGE_ID, "{} bytes from 0x{:04x} is not a memory range, it needs at least 1 byte and ends by 0xffff")
 
 // Create enum from error message list
 CREATE_ENUM(app_error_e, APP_ERROR_LIST)
@@ -1,4 +1,6 @@
 #include "cmd_line.h"
+#include "mcu_profile.h"
+#include <sstream>
 
 bool parse_param_exist(std::string param, std::string key){
 	// Len of param is correct or longer?
@@ -63,6 +65,52 @@ bool parse_param_hex_str(std::string param, std::string key, std::string &value)
 	return false;
 }
 
+// A comma separated list, e.g. units=1,2,0x10
+bool parse_param_list_uint8(std::string param, std::string key, std::vector<uint8_t> &value){
+	std::string::size_type i;
+	std::string::size_type next;
+
+	// Len of param is correct or longer?
+	if(param.size() >= (key.size() + 1)){
+		// Compares param to key word
+		if(param.compare(0, key.size(), key) == 0){
+			value.clear();
+			for(i = key.size(); i < param.size(); i = next + 1){
+				next = param.find(',', i);
+				if(next == std::string::npos){
+					next = param.size();
+				}
+				value.push_back((uint8_t)strtoul(param.substr(i, next - i).c_str(), NULL, 0));
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+// A comma separated list of strings, e.g. files=a.s19,b.s19
+bool parse_param_list_str(std::string param, std::string key, std::vector<std::string> &value){
+	std::string::size_type i;
+	std::string::size_type next;
+
+	// Len of param is correct or longer?
+	if(param.size() >= (key.size() + 1)){
+		// Compares param to key word
+		if(param.compare(0, key.size(), key) == 0){
+			value.clear();
+			for(i = key.size(); i < param.size(); i = next + 1){
+				next = param.find(',', i);
+				if(next == std::string::npos){
+					next = param.size();
+				}
+				value.push_back(param.substr(i, next - i));
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
 void usage(char *arg_0){
 	printf("%s ver 20240803. Truong Hy\n", arg_0);
 	printf("Usage:\n");
@@ -70,18 +118,71 @@ void usage(char *arg_0){
 	printf("devparams:\n");
 	printf("  path=<s>      : serial port path\n");
 	printf("  [timeout=<n>] : timeout ms\n");
+	printf("  [latency=<n>] : adapter latency of each write and reply wait in us, default 1000. Used for the time\n");
+	printf("                  estimate, a run much slower than its estimate points to a degraded adapter or cable\n");
+	printf("  [dryrun=<y|n>]: print the time estimate of the command (or of each job step) without opening the port\n");
 	printf("  [talker=<s>]  : talker file\n");
+	printf("  [xtal=<n>]    : crystal frequency in Hz, default 8000000. Scales the bootloader baud rates, selects the\n");
+	printf("                  fastest standard talker baud rate within 2%% and patches the talker's delays for it\n");
+	printf("  [baud=<n>]    : maximum talker baud rate, default the fastest the crystal can make\n");
+	printf("  [line_errors=<n>] : after a link error with this many frame, overrun, parity or break errors (Linux\n");
+	printf("                  TIOCGICOUNT, Windows error flags), lower the talker baud rate and resume, default 1, 0 = off\n");
+	printf("  [units=<n,..>] : multi-drop, MCUs sharing the serial line with these unit addresses (1 to 254), read by\n");
+	printf("                  each MCU from unit_addr=.  Writes are broadcast to all of them, then each one is verified.\n");
+	printf("                  Other commands go to the first unit.  Needs 9-bit mark/space parity on the adapter and a\n");
+	printf("                  talker assembled with MultiDrop set and RamSize > 512\n");
+	printf("  [unit_addr=<n>] : location of each MCU's unit address, default 0x100a (port E strapped on each board)\n");
+	printf("  [compress=<y|n>] : write run-length encoded (needs a talker assembled with RamSize > 256)\n");
+	printf("  [block=<y|n>] : program EEPROM/EPROM a block at a time, sent at full line rate into the talker's RAM\n");
+	printf("                  then checked with one checksum (needs a talker assembled with RamSize > 512)\n");
+	printf("  [frame=<y|n>] : framed mode, each command header is checked with a CRC-16 and each chunk read is\n");
+	printf("                  checked with a checksum, a bad chunk is sent again and the link resynchronised\n");
+	printf("                  (needs a talker assembled with RamSize > 512, not with compress=y or block=y)\n");
+	printf("  [mcu=<s>]     : MCU profile %s. Sets the default ram=, writes to\n", mcu_profile_names().c_str());
+	printf("                  the wrong memory type are rejected before anything is sent, write_e/write_e20 use\n");
+	printf("                  the MCU's EPROM command. auto detects the MCU once the talker is running (writes\n");
+	printf("                  and restores RAM above 256 bytes and the EPROG/PPROG ELAT bit)\n");
 	printf("\n");
 	printf("cmdparams:\n");
 	printf("uptalker        : upload talker\n");
 	printf("  [fast=<y|n>]  : upload talker with 7812 baud\n");
 	printf("  [talker=<s>]  : talker file\n");
+	printf("  [ram=<n>]     : RAM size 256, 512, 768 or 1024. When more than 256, only the talker bytes are sent\n");
+	printf("  [ping=<y|n>]  : skip the upload if the talker is already running (not straight after a reset,\n");
+	printf("                  the bootloader may take the ping as its sync char)\n");
+	printf("  [loader=<s>]  : two-stage boot, upload loader file then the talker at 9600 baud (needs ram= above 256)\n");
 	printf("read            : read memory to file\n");
 	printf("  from_addr=<n>  : from address\n");
 	printf("  to_addr=<n>    : to address\n");
 	printf("  file=<s>       : file\n");
+	printf("  [all=<y|n>]    : instead of from_addr/to_addr, read every mapped region of the mcu= profile\n");
+	printf("  [rle=<y|n>]    : read run-length encoded (faster for blank memory)\n");
+	printf("  [sync=<y|n>]   : update the file from its previous read, the talker checksums each 256 byte block\n");
+	printf("                   then the 16 byte sub-blocks of a block that changed, and only those that changed\n");
+	printf("                   are read (needs a talker assembled with RamSize > 256)\n");
 	printf("verify          : verify memory with file\n");
 	printf("  file=<s>       : file\n");
+	printf("blankcheck      : check memory is erased ($FF), showing the first byte that is not\n");
+	printf("  from_addr=<n>  : from address\n");
+	printf("  to_addr=<n>    : to address\n");
+	printf("  [all=<y|n>]    : instead of from_addr/to_addr, check every EEPROM and EPROM region of the mcu= profile\n");
+	printf("                   (the talker scans the range itself when assembled with RamSize > 512, else the range\n");
+	printf("                   is read, rle=y makes that faster)\n");
+	printf("memtest         : March C- RAM test on the MCU, each of its elements is one talker scan over the range so\n");
+	printf("                  only the failures are sent (needs a talker assembled with RamSize > 512, not MultiDrop)\n");
+	printf("  from_addr=<n>  : from address, the talker, the scan routine and the stack are skipped\n");
+	printf("  to_addr=<n>    : to address\n");
+	printf("  [talker=<s>]   : talker file, for the size of the talker to skip\n");
+	printf("  [ee=<y|n>]     : EEPROM cell test instead, each cell is programmed with $55 then $AA and the range is\n");
+	printf("                   scanned after each, then the original contents are programmed back\n");
+	printf("call            : call a routine in the MCU's memory and show the registers it returns with (needs a\n");
+	printf("                  talker assembled with RamSize > 512, not MultiDrop). Its X is the routine address, it\n");
+	printf("                  must end with RTS and may run for up to timeout=\n");
+	printf("  from_addr=<n>  : routine address\n");
+	printf("  [hex=<s>]      : hex string of the routine, written to from_addr first\n");
+	printf("  [reg_a=<n>]    : register A, default 0\n");
+	printf("  [reg_b=<n>]    : register B, default 0\n");
+	printf("  [reg_y=<n>]    : register Y, default 0\n");
 	printf("write_hex       : write hex string to memory\n");
 	printf("  from_addr=<n>  : from address\n");
 	printf("  hex=<s>        : hex string\n");
@@ -96,6 +197,34 @@ void usage(char *arg_0){
 	printf("  file=<s>       : file\n");
 	printf("write_e20       : write file to EPROM (E20, 12V)\n");
 	printf("  file=<s>       : file\n");
+	printf("  [pulse=<n>]    : write_e/write_e20 with adaptive pulses of n x 0.1ms, each byte is verified after each\n");
+	printf("                   pulse then given a margin pulse as long as the pulses it took (needs a talker\n");
+	printf("                   assembled with RamSize > 256), e.g. pulse=10 for 1ms\n");
+	printf("  [pulse_max=<n>]: maximum pulses per byte before it fails, default 25\n");
+	printf("  [blank=<y|n>]  : write_e/write_e20 blank check the file's addresses first and stop before anything is\n");
+	printf("                   programmed if one is not $FF, default y (not when resuming from a journal)\n");
+	printf("  [confirm=<y|n>]: answer yes to the programming confirmation (any of the EEPROM/EPROM writes)\n");
+	printf("  [journal=<s>]  : write/write_ee/write_e/write_e20 progress journal file, the last verified address of each\n");
+	printf("                   region is saved after each block so a rerun resumes there, without programming the\n");
+	printf("                   bytes already done again. Deleted once the whole file passed\n");
+	printf("  [retry=<n>]    : after a link error resynchronise with the talker and retry the block up to n times,\n");
+	printf("                   a block that already matches when read back is not written again\n");
+	printf("write_all       : merge several files into one image and write it in one session, a step per memory\n");
+	printf("                  type of the mcu= profile: RAM (with the registers and external memory), EEPROM, EPROM,\n");
+	printf("                  then CONFIG last. Files with a common address are rejected before anything is written\n");
+	printf("  files=<s,..>   : files\n");
+	printf("                   the write_e/write_e20 options (pulse=, blank=) apply to the EPROM step, each step has\n");
+	printf("                   its own programming confirmation and journal= gets the step name appended\n");
+	printf("daemon          : keep the serial port open and run commands sent to a UNIX domain socket (Linux)\n");
+	printf("  [socket=<s>]   : socket path, default /tmp/tru11.sock\n");
+	printf("                   each request is a line of cmdparams, e.g. read from_addr=0 to_addr=0xff\n");
+	printf("                   the reply is a line: OK <n>, FAILED <n> or ERROR <n> <error>, then the n bytes\n");
+	printf("                   of command output. daemon and job= are not requests\n");
+	printf("                   requests: status (talker state, baud and MCU), quit (stop the daemon)\n");
+	printf("job=<s>         : run the commands in a job file with one serial port session, one line of cmdparams\n");
+	printf("                  per step (# starts a comment), stops at the first failed step. devparams given on the\n");
+	printf("                  command line apply to every step, e.g. lines: uptalker / write_ee file=a.s19 confirm=y\n");
+	printf("                  / verify file=a.s19\n");
 }
 
 bool parse_params_search(char *cmdl_param, cl_my_params *my_params){
@@ -119,6 +248,26 @@ bool parse_params_search(char *cmdl_param, cl_my_params *my_params){
 		my_params->cmd = CMD_WRITE_EE_HEXSTR;
 		return true;
 	}
+	if(parse_param_exist(cmdl_param, "blankcheck")){
+		my_params->cmd = CMD_BLANK_CHECK;
+		return true;
+	}
+	if(parse_param_exist(cmdl_param, "memtest")){
+		my_params->cmd = CMD_MEMTEST;
+		return true;
+	}
+	if(parse_param_exist(cmdl_param, "call")){
+		my_params->cmd = CMD_CALL;
+		return true;
+	}
+	if(parse_param_exist(cmdl_param, "daemon")){
+		my_params->cmd = CMD_DAEMON;
+		return true;
+	}
+	if(parse_param_exist(cmdl_param, "write_all")){
+		my_params->cmd = CMD_WRITE_ALL;
+		return true;
+	}
 	if(parse_param_exist(cmdl_param, "write")){
 		my_params->cmd = CMD_WRITE_NORMAL;
 		return true;
@@ -141,12 +290,91 @@ bool parse_params_search(char *cmdl_param, cl_my_params *my_params){
 	if(parse_param_val_uint(cmdl_param, "timeout=", my_params->timeoutms)){
 		return true;
 	}
+	if(parse_param_val_uint(cmdl_param, "xtal=", my_params->xtal_hz)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "baud=", my_params->max_baud)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "line_errors=", my_params->line_error_limit)){
+		return true;
+	}
+	if(parse_param_list_uint8(cmdl_param, "units=", my_params->units)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "unit_addr=", my_params->unit_addr)){
+		return true;
+	}
 	if(parse_param_str(cmdl_param, "talker=", my_params->talker_filename)){
 		return true;
 	}
+	if(parse_param_val_uint(cmdl_param, "ram=", my_params->ram_size)){
+		return true;
+	}
+	if(parse_param_str(cmdl_param, "loader=", my_params->loader_filename)){
+		return true;
+	}
 	if(parse_param_yn(cmdl_param, "fast=", my_params->use_fast)){
 		return true;
 	}
+	if(parse_param_yn(cmdl_param, "rle=", my_params->use_rle)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "compress=", my_params->use_compress)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "block=", my_params->use_block)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "sync=", my_params->use_sync)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "frame=", my_params->use_frame)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "ping=", my_params->use_ping)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "confirm=", my_params->use_confirm)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "all=", my_params->use_all)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "blank=", my_params->use_blank)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "ee=", my_params->use_ee)){
+		return true;
+	}
+	if(parse_param_yn(cmdl_param, "dryrun=", my_params->use_dryrun)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "latency=", my_params->latency_us)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "pulse=", my_params->pulse_width)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "pulse_max=", my_params->pulse_max)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "retry=", my_params->retry_count)){
+		return true;
+	}
+	if(parse_param_str(cmdl_param, "journal=", my_params->journal_filename)){
+		return true;
+	}
+	if(parse_param_str(cmdl_param, "mcu=", my_params->mcu_name)){
+		return true;
+	}
+	if(parse_param_str(cmdl_param, "socket=", my_params->socket_path)){
+		return true;
+	}
+	if(parse_param_str(cmdl_param, "job=", my_params->job_filename)){
+		my_params->cmd = CMD_JOB;
+		return true;
+	}
 	if(parse_param_val_uint(cmdl_param, "from_addr=", my_params->from_addr)){
 		return true;
 	}
@@ -156,9 +384,21 @@ bool parse_params_search(char *cmdl_param, cl_my_params *my_params){
 	if(parse_param_str(cmdl_param, "file=", my_params->full_file_name)){
 		return true;
 	}
+	if(parse_param_list_str(cmdl_param, "files=", my_params->file_names)){
+		return true;
+	}
 	if(parse_param_str(cmdl_param, "hex=", my_params->data)){
 		return true;
 	}
+	if(parse_param_val_uint(cmdl_param, "reg_a=", my_params->reg_a)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "reg_b=", my_params->reg_b)){
+		return true;
+	}
+	if(parse_param_val_uint(cmdl_param, "reg_y=", my_params->reg_y)){
+		return true;
+	}
 	
 
 	return false;
@@ -170,3 +410,13 @@ void parse_params(int arg_c, char *arg_v[], cl_my_params *my_params){
 		parse_params_search(arg_v[i], my_params);
 	}
 }
+
+// Parse a line of space separated parameters, e.g. a job file step
+void parse_params_line(std::string line, cl_my_params *my_params){
+	std::istringstream line_stream(line);
+	std::string param_str;
+
+	while(line_stream >> param_str){
+		parse_params_search(param_str.data(), my_params);
+	}
+}
@@ -3,6 +3,9 @@
 
 #include "my_buf.h"
 #include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
 
 // Command line commands
 typedef enum{
@@ -15,9 +18,22 @@ typedef enum{
 	CMD_WRITE_NORMAL,
 	CMD_WRITE_EE,
 	CMD_WRITE_E,
-	CMD_WRITE_E20
+	CMD_WRITE_E20,
+	CMD_BLANK_CHECK,
+	CMD_MEMTEST,
+	CMD_CALL,
+	CMD_WRITE_ALL,
+	CMD_DAEMON,
+	CMD_JOB
 }cmd_type;
 
+// A byte that did not verify
+typedef struct{
+	uint16_t addr;
+	uint8_t expected;
+	uint8_t actual;
+}mem_mismatch;
+
 // Note, because the 68HC11 has a 1 byte SCI (UART) receive buffer, the code (if fast enough) can read out one and receive another,
 // this means we are able to set our application UART buffer size to 2 even if the OS UART driver does not support buffering.
 // Programming EEPROM/EPROM require a delay in the 68HC11 firmware, and due to how Windows UART driver implement buffering - it
@@ -28,30 +44,95 @@ public:
 	unsigned char cmd;
 	std::string dev_path;
 	bool use_fast;
+	bool use_rle;
+	bool use_compress;
+	bool use_block;
+	bool use_sync;
+	bool use_frame;
+	bool use_ping;
+	bool use_confirm;
+	bool use_all;
+	bool use_dryrun;
+	bool use_blank;
+	bool use_ee;
+	uint32_t ram_size;
 	uint32_t serial_rxbuf_size;
 	uint32_t serial_txbuf_size;
 	uint32_t serial_prog_txbuf_size;
 	uint32_t timeoutms;
+	uint32_t latency_us;
+	uint32_t xtal_hz;
+	uint32_t max_baud;
+	uint32_t line_error_limit;
+	uint32_t unit_addr;
+	std::vector<uint8_t> units;  // Multi-drop unit addresses, empty = one MCU on the line
+	uint8_t pulse_width;
+	uint8_t pulse_max;
+	uint8_t retry_count;
 	uint8_t srec_datalen;
+	uint8_t frame_seq;  // Sequence number of the last frame header, kept across the commands of a session
+	uint8_t reg_a;  // Registers passed to a routine by the call command
+	uint8_t reg_b;
+	uint16_t reg_y;
 	bool verify_config;
+	bool is_prog_data;  // A programming command's parameters were sent, the talker may be in its data loop
 	std::string talker_filename;
+	std::string loader_filename;
+	std::string socket_path;
+	std::string job_filename;
+	std::string journal_filename;
+	std::string mcu_name;
 	std::string full_file_name;
+	std::vector<std::string> file_names;  // Images of write_all
 	std::string data;
 	uint32_t from_addr;
 	uint32_t to_addr;
+	std::ostream *out;  // Output of the commands
+	std::function<void(uint32_t arg_done, uint32_t arg_total)> on_progress;  // Bytes done of the read range or file, may be empty
+	std::vector<mem_mismatch> *mismatches;  // Verify and write mismatches are added, NULL = not collected
+	std::vector<uint8_t> *read_buf;  // Bytes read are added, NULL = not collected
 
 	cl_my_params() :
 		cmd(CMD_NONE),
 		use_fast(false),
+		use_rle(false),
+		use_compress(false),
+		use_block(false),
+		use_sync(false),
+		use_frame(false),
+		use_ping(false),
+		use_confirm(false),
+		use_all(false),
+		use_dryrun(false),
+		use_blank(true),
+		use_ee(false),
+		ram_size(0),  // 0 = from the mcu= profile, else 256 (A and 811E2 bootloaders always receive 256 bytes)
 		serial_rxbuf_size(256),  // If the serial driver doesn't buffer, set this to 2 or 1
 		serial_txbuf_size(256),  // If the serial driver doesn't buffer, set this to 2 or 1
 		serial_prog_txbuf_size(2),
 		timeoutms(1000),
+		latency_us(1000),  // USB serial adapters add about 1ms to each write drain and reply wait
+		xtal_hz(8000000),
+		max_baud(0),  // 0 = the fastest standard rate the crystal can make
+		line_error_limit(1),
+		unit_addr(0x100a),  // Port E
+		pulse_width(0),  // EPROM pulse width in 0.1ms units, 0 = the talker's fixed delay per byte
+		pulse_max(25),
+		retry_count(0),
 		srec_datalen(16),
+		frame_seq(0),
+		reg_a(0),
+		reg_b(0),
+		reg_y(0),
 		verify_config(false),
+		is_prog_data(false),
 		talker_filename("talker.s19"),
+		socket_path("/tmp/tru11.sock"),
 		from_addr(0),
-		to_addr(0){
+		to_addr(0),
+		out(&std::cout),
+		mismatches(NULL),
+		read_buf(NULL){
 	}
 };
 
@@ -131,8 +212,11 @@ bool parse_param_exist(std::string param, std::string key);
 bool parse_param_str(std::string param, std::string key, std::string &value);
 bool parse_param_yn(std::string param, std::string key, bool &value);
 bool parse_param_hex_str(std::string param, std::string key, std::string &value);
+bool parse_param_list_uint8(std::string param, std::string key, std::vector<uint8_t> &value);
+bool parse_param_list_str(std::string param, std::string key, std::vector<std::string> &value);
 void usage(char *arg_0);
 bool parse_params_search(char *cmdl_param, cl_my_params *my_params);
 void parse_params(int arg_c, char *arg_v[], cl_my_params *my_params);
+void parse_params_line(std::string line, cl_my_params *my_params);
 
 #endif
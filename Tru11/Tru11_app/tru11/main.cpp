@@ -56,786 +56,456 @@
 #include "cmd_line.h"
 #include "to_string.h"
 #include "serial_com.h"
-#include "my_buf.h"
 #include "my_file.h"
+#include "mcu_profile.h"
+#include "talker.h"
+#include "tru11_lib.h"
 #include <stdio.h>
 #include <iostream>
+#include <sstream>
+#include <vector>
 #include <format>
+#include <chrono>
 
 // For the Sleep/sleep function
 #if defined(WIN32) || defined(WIN64)
 #include <Windows.h>
 #else
 #include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #endif
 
-#define BOOTLOADER_MAX_BYTE_COUNT 256
-#define TALKER_MAX_BYTE_COUNT     256
-#define TALKER_READ_CMD           0x01
-#define TALKER_WRITE_CMD          0x02
-#define TALKER_WRITE_EE_CMD       0x03
-#define TALKER_WRITE_E_CMD        0x04
-#define TALKER_WRITE_E20_CMD      0x05
-#define SREC_ADDR_CHECKSUM_COUNT  3
-#define HC11_CONFIG_ADDR          0x103f
-
-// Generic transmit in blocks
-void tx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint32_t arg_len){
-	uint8_t *txbuf_p = arg_txbuf;
-	uint32_t chunklen = 0;
-	uint32_t xferredlen;
-	uint32_t remaining;
-
-	remaining = arg_len;
-	while(remaining){
-		chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
-		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
-		if(xferredlen != chunklen){
-			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
-		}
-		txbuf_p += chunklen;
-		remaining -= chunklen;
-	}
-}
-
-// Generic receive in blocks
-void rx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_rxbuf, uint32_t arg_len){
-	uint8_t *rxbuf_p = arg_rxbuf;
-	uint32_t chunklen = 0;
-	uint32_t xferredlen;
-	uint32_t remaining;
-
-	remaining = arg_len;
-	while(remaining){
-		chunklen = (remaining > arg_params->serial_rxbuf_size) ? arg_params->serial_rxbuf_size : remaining;
-		xferredlen = arg_serial_com->read_port(rxbuf_p, chunklen);
-		if(xferredlen != chunklen){
-			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_RX_FAIL_ID, app_error_string::messages[APP_ERROR_RX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
-		}
+#define ETA_INTERVAL_MS     5000
+#define SLOW_RUN_PERCENT    150  // A run this much of its estimate or more is reported as slow
 
-		rxbuf_p += chunklen;
-		remaining -= chunklen;
+bool prog_prompt_write(cl_my_params *arg_params, uint8_t arg_write_cmd_code){
+	switch(arg_write_cmd_code){
+		case TALKER_WRITE_EE_CMD:
+			*arg_params->out << "EEPROM PROGRAMMING CONFIRMATION:" << std::endl;
+			*arg_params->out << "Note, current content will be lost, are you sure you want to write (y/[n])? ";
+			break;
+		case TALKER_WRITE_E_CMD:
+		case TALKER_WRITE_E20_CMD:
+			*arg_params->out << "EPROM PROGRAMMING CONFIRMATION:" << std::endl;
+			*arg_params->out << "Note, programmed zero bits will become permanent, if yes, please apply the" << std::endl;
+			*arg_params->out << "programming voltage (12V) on VPPE pin now before continuing, are you sure " << std::endl;
+			*arg_params->out << "you want to write (y/[n])? ";
+			break;
 	}
-}
 
-void verify_echo(uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len){
-	for(uint32_t i = 0; i < arg_len; i++){
-		if(arg_txbuf[i] != arg_rxbuf[i]){
-			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_ECHO_ID, app_error_string::messages[APP_ERROR_ECHO_ID], std::format(app_error_string::messages[APP_ERROR_ECHO_INFO_ID], arg_txbuf[i], arg_rxbuf[i]));
-		}
+	// Already confirmed with the command line
+	if(arg_params->use_confirm){
+		*arg_params->out << "y" << std::endl;
+		return true;
 	}
-}
-
-// Generic transmit and receive in blocks
-void txrx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len, bool arg_verify_echo){
-	uint8_t *txbuf_p = arg_txbuf;
-	uint8_t *rxbuf_p = arg_rxbuf;
-	uint32_t chunklen = 0;
-	uint32_t xferredlen;
-	uint32_t remaining;
 
-	remaining = arg_len;
-	while(remaining){
-		chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
-
-		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
-		if(xferredlen != chunklen){
-			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+	char buf[256];
+	if(fgets(buf, sizeof(buf), stdin) != NULL){
+		if(buf[0] == 'y'){
+			return true;
 		}
+	}else{
+		*arg_params->out << std::endl;
+	}
 
-		rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
-		if(arg_verify_echo){
-			verify_echo(txbuf_p, rxbuf_p, chunklen);
-		}
+	return false;
+}
 
-		txbuf_p += chunklen;
-		rxbuf_p += chunklen;
-		remaining -= chunklen;
+bool run_plan(cl_my_params *arg_params, serial_com *arg_serial_com);
+
+// Run a command with the serial COM port already open
+// Returns false when a verify failed or a programming confirmation was declined
+bool run_cmd(cl_my_params *arg_params, serial_com *arg_serial_com){
+	bool is_passed = true;
+	time_estimate est;
+	talker_regs regs;
+	uint64_t est_us;
+	uint64_t elapsed_us;
+	std::chrono::steady_clock::time_point start_time;
+	std::chrono::steady_clock::time_point eta_time;
+	std::ostream *out = arg_params->out;
+	serial_line_errors line_errors;
+	bool is_line_errors;
+	bool is_mdrop = !arg_params->units.empty() && arg_params->cmd != CMD_UPTALKER;  // The upload is the same for all the MCUs
+
+	// A write plan runs each of its steps as a command
+	if(arg_params->cmd == CMD_WRITE_ALL){
+		return run_plan(arg_params, arg_serial_com);
 	}
-}
 
-// Transmit and receive in blocks specifically for downloading the control program
-void txrx_chunk_control_program(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len){
-	uint8_t *txbuf_p = arg_txbuf;
-	uint8_t *rxbuf_p = arg_rxbuf;
-	uint32_t chunklen = 0;
-	uint32_t xferredlen;
-	uint32_t remaining;
+	// Only the estimate, the port is not used
+	if(arg_params->use_dryrun){
+		estimate_cmd(arg_params, &est);
+		print_estimate(arg_params, &est);
+		return true;
+	}
 
-	remaining = arg_len;
-	while(remaining){
-		chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
-		remaining -= chunklen;
+	// Multi-drop, the units are selected before the MCU is detected
+	if(is_mdrop){
+		mdrop_begin(arg_params, arg_serial_com);
+	}
+	apply_mcu_profile(arg_params, arg_serial_com);
 
-		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
-		if(xferredlen != chunklen){
-			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
-		}
+	estimate_cmd(arg_params, &est);
+	est_us = est.line_us + est.wait_us + est.prog_us;
+	if(est_us){
+		print_estimate(arg_params, &est);
+	}
 
-		// Note this problem is to do with the use serial no control flow and the bootloader's baud rate changing scheme
-		// For the last byte: some USB to TTL serial adapters will not receive the last echoed byte
-		if(remaining == 0){
-			if(chunklen == 1){
-				// Note: some adapters will not receive the last echoed byte, if so we will ignore the error
-				// Read the last byte
-				try{
-					xferredlen = arg_serial_com->read_port(rxbuf_p, chunklen);
-					verify_echo(txbuf_p, rxbuf_p, chunklen);
-				}catch(tru_exception &ex){
-					(void)ex;  // Suppress unreferenced warning
-				}
-			}else{
-				// A workaround for some adapters, since last byte is missing we read one less normally
-				rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen - 1);
-				verify_echo(txbuf_p, rxbuf_p, chunklen - 1);
-
-				// Note: some adapters will not receive the last echoed byte, if so we will ignore the error
-				// Read the last byte
-				try{
-					xferredlen = arg_serial_com->read_port(rxbuf_p + chunklen - 1, 1);
-					verify_echo(txbuf_p, rxbuf_p + chunklen - 1, 1);
-				}catch(tru_exception &ex){
-					(void)ex;  // Suppress unreferenced warning
-				}
+	// Show the ETA from the rate so far
+	start_time = std::chrono::steady_clock::now();
+	eta_time = start_time;
+	if(est_us && !arg_params->on_progress){
+		arg_params->on_progress = [out, start_time, eta_time](uint32_t arg_done, uint32_t arg_total) mutable {
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			uint64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time).count();
+
+			if(arg_done && arg_done < arg_total && now - eta_time >= std::chrono::milliseconds(ETA_INTERVAL_MS)){
+				eta_time = now;
+				*out << "ETA " << est_time_str(elapsed_us * (arg_total - arg_done) / arg_done) << " (" << (uint64_t)arg_done * 100 / arg_total << "%)" << std::endl;
 			}
-		}else{
-			rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
-			verify_echo(txbuf_p, rxbuf_p, chunklen);
-		}
-
-		txbuf_p += chunklen;
-		rxbuf_p += chunklen;
+		};
 	}
-}
-
-// Transmit and receive in blocks specifically for writing memory
-void txrx_chunk_write(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len, bool arg_is_prog){
-	uint8_t *txbuf_p = arg_txbuf;
-	uint8_t *rxbuf_p = arg_rxbuf;
-	uint32_t chunklen = 0;
-	uint32_t xferredlen;
-	uint32_t remaining;
 
-	remaining = arg_len;
-	while(remaining){
-		if(arg_is_prog){
-			chunklen = (remaining > arg_params->serial_prog_txbuf_size) ? arg_params->serial_prog_txbuf_size : remaining;
-		}else{
-			chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
+	// Line errors during the command
+	is_line_errors = arg_serial_com->get_line_errors(&line_errors);
+	try{
+		is_passed = run_talker_cmd(arg_params, arg_serial_com, [arg_params](uint8_t arg_write_cmd_code){ return prog_prompt_write(arg_params, arg_write_cmd_code); }, &regs);
+		if(is_mdrop){
+			is_passed = mdrop_end(arg_params, arg_serial_com, is_passed);
 		}
-		remaining -= chunklen;
-
-		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
-		if(xferredlen != chunklen){
-			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+	}catch(tru_exception &){
+		if(is_line_errors){
+			print_line_errors(arg_params, arg_serial_com, &line_errors);
 		}
-
-		rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
-
-		txbuf_p += chunklen;
-		rxbuf_p += chunklen;
+		throw;
+	}
+	if(is_line_errors){
+		print_line_errors(arg_params, arg_serial_com, &line_errors);
 	}
-}
-
-// Note: all MCU types have minimum of 256 bytes RAM (some have more)
-void send_control_program(cl_my_params *arg_params, serial_com *arg_serial_com){
-	cl_my_file talker_file;
-	std::string line_str;
-	uint8_t srec_bytecount;
-	uint16_t byte_index = 0;
-	uint16_t pad_index;
-	uint8_t txbyte;
-	cl_my_buf txbuf;
-	cl_my_buf rxbuf;
-	uint8_t *txbuf_p;
-	uint8_t *rxbuf_p;
-	uint32_t len;
-
-	len = (arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT;
-	txbuf.alloc_buf(len);
-	txbuf_p = txbuf.get_buf();
-
-	len = (arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT;
-	rxbuf.alloc_buf(len);
-	rxbuf_p = rxbuf.get_buf();
-
-	std::cout << "Loading " << arg_params->talker_filename << std::endl;
-	talker_file.open_file(arg_params->talker_filename, "rb");
-
-	// =====================
-	// Read file into buffer
-	// =====================
-
-	do{
-		talker_file.read_file_line(line_str);
-
-		//std::cout << "Line: " << line_str << std::endl;
-
-		// Check for valid S1 record
-		if(line_str.size() > 8){
-			// S1 record type?
-			if(line_str.compare(0, 2, "S1") == 0){
-				srec_bytecount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16);  // Extract srecord data byte count
-				// Byte count is valid?
-				if((srec_bytecount > 0) && (srec_bytecount >= ((line_str.size() - 4) / 2))){
-					if(srec_bytecount > SREC_ADDR_CHECKSUM_COUNT){
-						std::cout << line_str << std::endl;
-						// Loop through record data (exclude the 16 bit address and 8 bit checksum)
-						for(pad_index = 0; pad_index < (uint8_t)(srec_bytecount - SREC_ADDR_CHECKSUM_COUNT); pad_index++){
-							// Not the 257th byte?
-							if(byte_index == BOOTLOADER_MAX_BYTE_COUNT){
-								throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TALKER_TOO_BIG_ID, std::format(app_error_string::messages[APP_ERROR_TALKER_TOO_BIG_ID], BOOTLOADER_MAX_BYTE_COUNT), "");
-							}
 
-							*txbuf_p = (uint8_t)strtoul(line_str.substr(2 * pad_index + 8, 2).c_str(), NULL, 16);
-							txbuf_p++;
-							byte_index++;
-						}
-					}
-				}
-			}
+	// Actual against predicted, the prompt is not counted
+	if(est_us && is_passed){
+		elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+		*arg_params->out << "Took " << est_time_str(elapsed_us) << ", estimated " << est_time_str(est_us) << std::endl;
+		if(elapsed_us * 100 >= est_us * SLOW_RUN_PERCENT){
+			*arg_params->out << "Warning: much slower than the estimate, check the adapter (latency=) and cable" << std::endl;
 		}
-	}while(!talker_file.eof());
-
-	// If control program is small, pad with 0x00 bytes
-	for(pad_index = byte_index; pad_index < BOOTLOADER_MAX_BYTE_COUNT; pad_index++){
-		*txbuf_p = 0x00;
-		txbuf_p++;
-		byte_index++;
 	}
+	arg_params->on_progress = nullptr;
 
-	// ========
-	// Download
-	// ========
-
-	// Transmit leading 0xff byte and no echo expected
-	std::cout << "Transmitting sync char 0xff" << std::endl;
-	txbyte = 0xff;
-	tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
-
-	// Transmit talker bytes
-	std::cout << "Transmitting talker bytes" << std::endl;
-	txbuf_p = txbuf.get_buf();
-	txrx_chunk_control_program(arg_params, arg_serial_com, txbuf_p, rxbuf_p, byte_index);
+	return is_passed;
 }
 
-void readmem(cl_my_params *arg_params, serial_com *arg_serial_com){
-	uint32_t i;
-	uint16_t addr;
-	cl_my_file out_file;
-	size_t bytes_written;
-	std::string srec_line;
-	std::string srec_addr_str;
-	uint8_t datacount = 0;
-	uint8_t srec_bytecount = SREC_ADDR_CHECKSUM_COUNT + arg_params->srec_datalen;
-	uint8_t checksum = 0;
-	cl_my_buf txbuf;
-	uint8_t *txbuf_p;
-	cl_my_buf rxbuf;
-	uint8_t *rxbuf_p;
-	uint32_t chunklen = 0;
-	uint32_t remaining;
-
-	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	txbuf_p = txbuf.get_buf();
-	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	rxbuf_p = rxbuf.get_buf();
-
-	if(arg_params->full_file_name.size() > 0){
-		out_file.open_file(arg_params->full_file_name, "wb");
+// Write several images in one session, see plan_write().  Each step runs as its write command, with the programming
+// confirmation, blank check and journal of that command.  Returns false when a step failed or was not confirmed
+bool run_plan(cl_my_params *arg_params, serial_com *arg_serial_com){
+	std::vector<plan_step> steps;
+	cl_my_params step_params;
+	size_t i;
+	bool is_passed = true;
+	time_estimate est;
+	uint64_t est_total_us = 0;
+
+	// The profile sorts the addresses into the steps, mcu=auto detects the MCU first
+	if(arg_params->mcu_name == MCU_PROFILE_AUTO && arg_params->units.empty() && !arg_params->use_dryrun){
+		apply_mcu_profile(arg_params, arg_serial_com);
 	}
 
-	// Write Motorola file format header S0 record
-	srec_line = "S0030000FC\r\n";
-	out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
-
-	checksum += (arg_params->from_addr >> 8) & 0xff;
-	checksum += arg_params->from_addr & 0xff;
-	srec_line.clear();
-	srec_addr_str = string_utils_ns::to_string_right_hex_up((uint16_t)arg_params->from_addr, 4, '0');
-	remaining = arg_params->to_addr - arg_params->from_addr + 1;
-	addr = (uint16_t)arg_params->from_addr;
-
-	while(remaining){
-		chunklen = (remaining > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : remaining;
-
-		rxbuf_p = rxbuf.get_buf();
-
-		// Transmit command
-		txbuf_p[0] = TALKER_READ_CMD;
-		txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, 1, true);
-
-		// Transmit parameters
-		txbuf_p[0] = (uint8_t)chunklen;
-		txbuf_p[1] = (uint8_t)(addr >> 8 & 0xff);
-		txbuf_p[2] = (uint8_t)(addr & 0xff);
-		tx_chunk(arg_params, arg_serial_com, txbuf_p, 3);
-
-		// Read a chunk of memory
-		rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
+	try{
+		plan_write(arg_params, &steps);
+		*arg_params->out << "Write plan of " << arg_params->file_names.size() << " file(s):";
+		for(i = 0; i < steps.size(); i++){
+			*arg_params->out << " " << steps[i].name << " " << steps[i].byte_count << " bytes" << ((i + 1 < steps.size()) ? "," : "");
+		}
+		*arg_params->out << std::endl << std::endl;
 
-		remaining -= chunklen;
+		for(i = 0; i < steps.size() && is_passed; i++){
+			*arg_params->out << "Plan step " << i + 1 << " of " << steps.size() << ": " << steps[i].name << std::endl;
 
-		for(i = 0; i < chunklen; i++){
-			if(datacount == 0){
-				std::cout << string_utils_ns::to_string_right_hex_up(addr, 4, '0') << ":";
+			step_params = *arg_params;
+			step_params.cmd = steps[i].cmd;
+			step_params.full_file_name = steps[i].file_name;
+			if(arg_params->journal_filename.size() > 0){
+				step_params.journal_filename = arg_params->journal_filename + "." + steps[i].name;
 			}
-
-			std::cout << string_utils_ns::to_string_right_hex_up((uint16_t)*rxbuf_p, 2, '0');
-
-			if(arg_params->full_file_name.size() > 0){
-				srec_line += string_utils_ns::to_string_right_hex_up((uint16_t)*rxbuf_p, 2, '0');
-				datacount++;
-				checksum += *rxbuf_p;
-
-				if(datacount == (srec_bytecount - SREC_ADDR_CHECKSUM_COUNT)){
-					checksum += datacount + SREC_ADDR_CHECKSUM_COUNT;
-					checksum = ~checksum;
-
-					// Create S1 record: S1 + length + checksum
-					srec_line =
-						"S1" +
-						string_utils_ns::to_string_right_hex_up((uint16_t)(datacount + SREC_ADDR_CHECKSUM_COUNT), 2, '0') +
-						srec_addr_str +
-						srec_line + string_utils_ns::to_string_right_hex_up((uint16_t)checksum, 2, '0') +
-						"\r\n";
-
-					// Write Motorola file format header S1 record
-					out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
-
-					datacount = 0;
-					checksum = 0;
-					checksum += ((addr + 1) >> 8) & 0xff;
-					checksum += (addr + 1) & 0xff;
-					srec_line.clear();
-					srec_addr_str = string_utils_ns::to_string_right_hex_up((uint16_t)(addr + 1), 4, '0');
-
-					std::cout << std::endl;
-				}
+			if(step_params.use_dryrun){
+				estimate_cmd(&step_params, &est);
+				est_total_us += est.line_us + est.wait_us + est.prog_us;
 			}
+			is_passed = run_cmd(&step_params, arg_serial_com);
+			arg_params->max_baud = step_params.max_baud;  // Keep a lowered baud rate, the talker runs at it
+			arg_params->frame_seq = step_params.frame_seq;
 
-			rxbuf_p++;
-			addr++;
+			*arg_params->out << std::endl;
 		}
+	}catch(tru_exception &){
+		plan_remove(&steps);
+		throw;
 	}
+	plan_remove(&steps);
 
-	if(arg_params->full_file_name.size() > 0){
-		// Do we have remaining bytes?
-		if(datacount > 0){
-			checksum += datacount + SREC_ADDR_CHECKSUM_COUNT;
-			checksum = ~checksum;
-
-			// Create S1 record: S1 + length + checksum
-			srec_line =
-				"S1" +
-				string_utils_ns::to_string_right_hex_up((uint16_t)(datacount + SREC_ADDR_CHECKSUM_COUNT), 2, '0') +
-				srec_addr_str +
-				srec_line + string_utils_ns::to_string_right_hex_up((uint16_t)checksum, 2, '0') +
-				"\r\n";
+	if(est_total_us){
+		*arg_params->out << "Plan estimate " << est_time_str(est_total_us) << std::endl;
+	}
+	if(is_passed){
+		*arg_params->out << "PLAN PASSED. " << i << " steps completed" << std::endl;
+	}else{
+		*arg_params->out << "PLAN FAILED! Step " << i << " failed" << std::endl;
+	}
+	return is_passed;
+}
 
-			// Write Motorola file format header S1 record
-			out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+#if !(defined(WIN32) || defined(WIN64))
+// Send a string to a socket client
+void daemon_send(int arg_fd, std::string arg_str){
+	const char *buf_p = arg_str.c_str();
+	size_t remaining = arg_str.size();
+	ssize_t xferredlen;
 
-			std::cout << std::endl;
+	while(remaining){
+		xferredlen = send(arg_fd, buf_p, remaining, MSG_NOSIGNAL);
+		if(xferredlen <= 0){
+			throw tru_exception::get_clib_last_error(__func__, "");
 		}
-
-		// Create footer S9 record
-		srec_line = "S9030000FC\r\n";
-
-		// Write Motorola file format termination S9 record
-		out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+		buf_p += xferredlen;
+		remaining -= xferredlen;
 	}
-
-	std::cout << std::endl << "Read successfully completed" << std::endl;
 }
 
-void readmem_verify(cl_my_params *arg_params, serial_com *arg_serial_com){
-	uint32_t i;
-	cl_my_file in_file;
+// Daemon: keep the serial COM port (and so the talker) open, and run commands received from a UNIX domain socket
+// Each request is a line of command parameters, same as the command line. The reply is a status line: OK, FAILED
+// (verify mismatch or programming not confirmed) or ERROR, then the byte count of the output and for ERROR the error,
+// followed by exactly that many bytes of command output
+void run_daemon(cl_my_params *arg_params, serial_com *arg_serial_com){
+	int listen_fd;
+	int client_fd;
+	struct sockaddr_un addr;
+	char rxbuf[256];
+	ssize_t rxlen;
 	std::string line_str;
-	std::string ic_line_str;
-	uint16_t srec_addr;
-	uint8_t srec_datacount;
-	uint32_t total_databytes = 0;
-	uint8_t file_byte;
-	cl_my_buf txbuf;
-	uint8_t *txbuf_p;
-	cl_my_buf rxbuf;
-	uint8_t *rxbuf_p;
-	uint32_t line_mismatch_count;
-	uint32_t mismatch_count = 0;
-	uint32_t line_ignore_count;
-	uint32_t ignore_count = 0;
-
-	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	txbuf_p = txbuf.get_buf();
-	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	rxbuf_p = rxbuf.get_buf();
-
-	in_file.open_file(arg_params->full_file_name, "rb");
-
-	do{
-		// Read line from file
-		in_file.read_file_line(line_str);
-
-		// Record string length must be atleast the minimum of 8
-		if(line_str.size() >= 8){
-			// We only want S1 records
-			if(line_str.substr(0, 2) == "S1"){
-				std::cout << "File: " << line_str << std::endl;
-				srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
-				srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;  // Extract srecord data byte count
-
-				ic_line_str.clear();
-				line_mismatch_count = 0;
-				line_ignore_count = 0;
-				rxbuf_p = rxbuf.get_buf();
-
-				// Transmit command
-				txbuf_p[0] = TALKER_READ_CMD;
-				txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, 1, true);
-
-				// Transmit parameters
-				txbuf_p[0] = (uint8_t)srec_datacount;
-				txbuf_p[1] = (uint8_t)(srec_addr >> 8 & 0xff);
-				txbuf_p[2] = (uint8_t)(srec_addr & 0xff);
-				tx_chunk(arg_params, arg_serial_com, txbuf_p, 3);
-
-				// Read a chunk of memory
-				rx_chunk(arg_params, arg_serial_com, rxbuf_p, srec_datacount);
-
-				// Loop each data byte
-				for(i = 0; i < srec_datacount; i++){
-					if(!arg_params->verify_config && srec_addr == HC11_CONFIG_ADDR){
-						line_ignore_count++;
-						ignore_count++;
-					}else{
-						file_byte = (uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
-						if(*rxbuf_p != file_byte){
-							line_mismatch_count++;
-							mismatch_count++;
-						}
-					}
+	std::string::size_type pos;
+	std::string param_str;
+	std::istringstream line_stream;
+	std::ostringstream out_stream;
+	cl_my_params req_params;
+	bool is_talker_running = false;
+	bool is_passed;
+	bool is_detect;
+	bool is_status;
+	bool is_quit = false;
+	std::string status_str;
+
+	// Sockets are closed on exit, ignore SIGPIPE so a client disconnecting does not end the daemon
+	signal(SIGPIPE, SIG_IGN);
+
+	// Requests cannot answer a prompt, without confirm=y the programming confirmation reads no and is cancelled
+	if(freopen("/dev/null", "r", stdin) == NULL){
+		throw tru_exception::get_clib_last_error(__func__, "");
+	}
 
-					ic_line_str += string_utils_ns::to_string_right_hex_up((uint16_t)*rxbuf_p, 2, '0');
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(listen_fd < 0){
+		throw tru_exception::get_clib_last_error(__func__, "");
+	}
 
-					srec_addr++;
-					rxbuf_p++;
-				}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, arg_params->socket_path.c_str(), sizeof(addr.sun_path) - 1);
+	unlink(arg_params->socket_path.c_str());  // Remove a socket left over from before
+	if(bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(listen_fd, 1)){
+		close(listen_fd);
+		throw tru_exception::get_clib_last_error(__func__, arg_params->socket_path);
+	}
 
-				if(line_mismatch_count && line_ignore_count){
-					std::cout << "Rx  :         " << ic_line_str << " = " << line_mismatch_count << " mismatched, " << line_ignore_count << " ignored" << std::endl;
-				}else if(line_mismatch_count){
-					std::cout << "Rx  :         " << ic_line_str << " = " << line_mismatch_count << " mismatched" << std::endl;
-				}else if(line_ignore_count == srec_datacount){
-					std::cout << "Rx  :         " << ic_line_str << " = " << line_ignore_count << " ignored" << std::endl;
-				}else if(line_ignore_count){
-					std::cout << "Rx  :         " << ic_line_str << " = " << (uint16_t)srec_datacount << " matched, " << line_ignore_count << " ignored" << std::endl;
-				}else{
-					std::cout << "Rx  :         " << ic_line_str << " = " << (uint16_t)srec_datacount << " matched" << std::endl;
-				}
+	arg_serial_com->set_params(get_talker_baud(arg_params), 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
+	*arg_params->out << "Daemon listening on " << arg_params->socket_path << std::endl;
 
-				total_databytes += srec_datacount;
-			}
+	while(!is_quit){
+		client_fd = accept(listen_fd, NULL, NULL);
+		if(client_fd < 0){
+			continue;
 		}
-	}while(!in_file.eof());
 
-	if(mismatch_count){
-		if(ignore_count){
-			std::cout << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched, " << ignore_count << " ignored" << std::endl;
-		}else{
-			std::cout << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched" << std::endl;
-		}
-	}else{
-		if(ignore_count){
-			std::cout << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched, " << ignore_count <<  " ignored" << std::endl;
-		}else{
-			std::cout << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched" << std::endl;
-		}
-	}
-}
+		try{
+			line_str.clear();
+			while(!is_quit && (rxlen = recv(client_fd, rxbuf, sizeof(rxbuf), 0)) > 0){
+				line_str.append(rxbuf, rxlen);
+
+				// Run each complete request line
+				while(!is_quit && (pos = line_str.find('\n')) != std::string::npos){
+					line_stream.clear();
+					line_stream.str(line_str.substr(0, pos));
+					line_str.erase(0, pos + 1);
+
+					// Each request starts from the daemon's own parameters
+					req_params = *arg_params;
+					req_params.cmd = CMD_NONE;
+					is_status = false;
+
+					// Capture the output of the command for the reply
+					out_stream.str("");
+					req_params.out = &out_stream;
+					is_passed = true;
+					try{
+						while(line_stream >> param_str){
+							if(param_str == "status"){
+								is_status = true;
+							}else if(param_str == "quit"){
+								is_quit = true;
+							}else{
+								parse_params_search(param_str.data(), &req_params);
+							}
+						}
 
-void writemem_hexstr(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code){
-	uint16_t addr;
-	uint8_t chunklen = 0;
-	uint32_t remaining;
-	uint32_t total_bytes;
-	cl_my_buf txbuf;
-	uint8_t *txbuf_p;
-	cl_my_buf rxbuf;
-	uint8_t *rxbuf_p;
-
-	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	txbuf_p = txbuf.get_buf();
-	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	rxbuf_p = rxbuf.get_buf();
-
-	if(arg_params->data.size() > 0){
-		if(arg_params->data.size() % 2){
-			arg_params->data = "0" + arg_params->data;
-		}
+						if(is_status){
+							out_stream << "talker=" << (is_talker_running ? "running" : "unknown") << std::endl;
+							out_stream << "baud=" << get_talker_baud(arg_params) << std::endl;
+							out_stream << "mcu=" << ((arg_params->mcu_name.size() > 0) ? arg_params->mcu_name : "unknown") << std::endl;
+						}else if(req_params.cmd == CMD_NONE && is_quit){
+							// Only quit, nothing to run
+						}else if(req_params.cmd == CMD_NONE || req_params.cmd == CMD_DAEMON || req_params.cmd == CMD_JOB){
+							throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_DAEMON_REQUEST_ID, app_error_string::messages[APP_ERROR_DAEMON_REQUEST_ID], line_stream.str());
+						}else{
+							is_detect = (req_params.mcu_name == MCU_PROFILE_AUTO);
+							is_passed = run_cmd(&req_params, arg_serial_com);
+							if(req_params.cmd == CMD_UPTALKER){
+								is_talker_running = true;
+							}
+							if(is_detect){
+								arg_params->mcu_name = req_params.mcu_name;  // Keep a detected MCU for the next requests
+							}
+							arg_params->max_baud = req_params.max_baud;  // Keep a lowered baud rate, the talker runs at it
+							arg_params->frame_seq = req_params.frame_seq;
+						}
+						status_str = is_passed ? "OK " : "FAILED ";
+						status_str += std::to_string(out_stream.str().size());
+					}catch(tru_exception &ex){
+						status_str = "ERROR " + std::to_string(out_stream.str().size()) + " " + ex.get_error();
+						if(ex.get_source() != TRU_EXCEPT_SRC_VEN || ex.get_code() != APP_ERROR_DAEMON_REQUEST_ID){  // A rejected request did not use the port
+							is_talker_running = false;  // We no longer know the state of the talker
+							arg_serial_com->purge();  // Clear any bytes left from the failed command
+						}
+					}catch(std::exception &ex){
+						// Not one of ours (e.g. out of memory or a bad number), keep serving the next requests
+						status_str = "ERROR " + std::to_string(out_stream.str().size()) + " " + ex.what();
+						is_talker_running = false;
+						arg_serial_com->purge();
+					}
 
-		total_bytes = arg_params->data.size() / 2;
-		addr = arg_params->from_addr;
-		remaining = total_bytes;
-
-		std::cout << string_utils_ns::to_string_right_hex_up(arg_params->from_addr, 4, '0') << ":" << arg_params->data << std::endl;
-
-		// Loop each data byte
-		while(remaining){
-			chunklen = (remaining > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : remaining;
-
-			// Transmit command
-			txbuf_p = txbuf.get_buf();
-			rxbuf_p = rxbuf.get_buf();
-			txbuf_p[0] = arg_write_cmd_code;
-			txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, 1, true);
-
-			// Transmit parameters
-			txbuf_p[0] = (uint8_t)chunklen;
-			txbuf_p[1] = (uint8_t)(addr >> 8 & 0xff);
-			txbuf_p[2] = (uint8_t)(addr & 0xff);
-			tx_chunk(arg_params, arg_serial_com, txbuf_p, 3);
-
-			// Write and receive a chunk of memory
-			txbuf_p = txbuf.get_buf();
-			rxbuf_p = rxbuf.get_buf();
-			for(uint16_t i = 0; i < chunklen; i++){
-				txbuf_p[i] = (uint8_t)strtoul(arg_params->data.substr(2 * (addr - arg_params->from_addr + i), 2).c_str(), NULL, 16);
+					daemon_send(client_fd, status_str + "\n" + out_stream.str());
+				}
 			}
-			txrx_chunk_write(arg_params, arg_serial_com, txbuf_p, rxbuf_p, chunklen, false);
-
-			addr += chunklen;
-			remaining -= chunklen;
+		}catch(tru_exception &ex){
+			*arg_params->out << "Error: " << ex.get_error() << std::endl;
 		}
+
+		close(client_fd);
 	}
+
+	close(listen_fd);
+	unlink(arg_params->socket_path.c_str());
 }
+#endif
 
-// Note, when programming the CONFIG register 0x103f the new value cannot be read until a reset
-void writemem_file(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code){
-	uint32_t i;
-	uint32_t bytecount = 0;
-	cl_my_file in_file;
+// Job: run the commands in a job file, one step per line, with one serial COM port session. Each step starts from
+// the command line parameters. Stops at the first failed step, the job result is also the exit code
+void run_job(cl_my_params *arg_params, serial_com *arg_serial_com){
+	cl_my_file job_file;
 	std::string line_str;
-	std::string srec_type;
-	uint8_t srec_datacount;
-	uint32_t total_databytes = 0;
-	uint16_t srec_addr;
-	cl_my_buf txbuf;
-	uint8_t *txbuf_p;
-	cl_my_buf rxbuf;
-	uint8_t *rxbuf_p;
-	uint32_t line_mismatch_count;
-	uint32_t mismatch_count = 0;
-	uint32_t line_ignore_count;
-	uint32_t ignore_count = 0;
-
-	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	txbuf_p = txbuf.get_buf();
-	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
-	rxbuf_p = rxbuf.get_buf();
-
-	in_file.open_file(arg_params->full_file_name, "rb");
+	std::string::size_type pos;
+	std::vector<std::string> step_lines;
+	cl_my_params step_params;
+	uint32_t i;
+	bool is_passed = true;
+	bool is_detect;
+	time_estimate est;
+	uint64_t est_total_us = 0;
 
+	// Read all the steps first, so an unreadable job file is found before anything is programmed
+	job_file.open_file(arg_params->job_filename, "rb");
 	do{
-		// Read line from file
-		in_file.read_file_line(line_str);
-
-		// Record string length must be atleast the minimum of 8
-		if(line_str.size() >= 8){
-			// We only want S1 records
-			srec_type = line_str.substr(0, 2);
-			if(srec_type == "S1"){
-				//std::cout << line_str << std::endl;
-				srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;  // Extract srecord data byte count
-				srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);  // Extract srecord address
-
-				std::cout << string_utils_ns::to_string_right_hex_up(srec_addr, 4, '0') << ":";
-
-				// Transmit command
-				txbuf_p = txbuf.get_buf();
-				rxbuf_p = rxbuf.get_buf();
-				txbuf_p[0] = arg_write_cmd_code;
-				txrx_chunk(arg_params, arg_serial_com, txbuf_p, rxbuf_p, 1, true);
-
-				// Transmit parameters
-				txbuf_p[0] = (uint8_t)srec_datacount;
-				txbuf_p[1] = (uint8_t)(srec_addr >> 8 & 0xff);
-				txbuf_p[2] = (uint8_t)(srec_addr & 0xff);
-				tx_chunk(arg_params, arg_serial_com, txbuf_p, 3);
-
-				// Loop each data byte appending them into a buffer
-				for(i = 0; i < srec_datacount; i++){
-					*txbuf_p = (uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
-					std::cout << string_utils_ns::to_string_right_hex_up((uint16_t)(*txbuf_p), 2, '0');
-
-					txbuf_p++;
-					bytecount++;
-				}
+		line_str.clear();
+		job_file.read_file_line(line_str);
 
-				// Write and receive a chunk of memory
-				txbuf_p = txbuf.get_buf();
-				rxbuf_p = rxbuf.get_buf();
-				txrx_chunk_write(arg_params, arg_serial_com, txbuf_p, rxbuf_p, srec_datacount, arg_write_cmd_code != TALKER_WRITE_CMD);
-
-				line_mismatch_count = 0;
-				line_ignore_count = 0;
-				for(i = 0; i < srec_datacount; i++){
-					if(!arg_params->verify_config && srec_addr == HC11_CONFIG_ADDR){  // We cannot read the new config value until after a reset so we will not verify it
-						line_ignore_count++;
-						ignore_count++;
-					}else{
-						if(txbuf_p[i] != rxbuf_p[i]){
-							line_mismatch_count++;
-							mismatch_count++;
+		// Remove comment and trailing spaces
+		pos = line_str.find('#');
+		if(pos != std::string::npos){
+			line_str.erase(pos);
+		}
+		line_str.erase(line_str.find_last_not_of(" \t\r") + 1);
 
-						}
-					}
-					srec_addr++;
-				}
+		// Skip blank line
+		if(line_str.size() > 0){
+			step_lines.push_back(line_str);
+		}
+	}while(!job_file.eof());
+	job_file.close_file();
 
-				if(line_mismatch_count && line_ignore_count){
-					std::cout << " = " << line_mismatch_count << " mismatched, " << line_ignore_count << " ignored" << std::endl;
-				}else if(line_mismatch_count){
-					std::cout << " = " << line_mismatch_count << " mismatched" << std::endl;
-				}else if(line_ignore_count == srec_datacount){
-					std::cout << " = " << line_ignore_count << " ignored" << std::endl;
-				}else if(line_ignore_count){
-					std::cout << " = " << (uint16_t)srec_datacount << " matched, " << line_ignore_count << " ignored" << std::endl;
-				}else{
-					std::cout << " = " << (uint16_t)srec_datacount << " matched" << std::endl;
-				}
+	for(i = 0; i < step_lines.size() && is_passed; i++){
+		*arg_params->out << "Job step " << i + 1 << " of " << step_lines.size() << ": " << step_lines[i] << std::endl;
 
-				total_databytes += srec_datacount;
-			}
+		step_params = *arg_params;
+		step_params.cmd = CMD_NONE;
+		parse_params_line(step_lines[i], &step_params);
+		if(!arg_params->use_dryrun){
+			arg_serial_com->set_timeout(step_params.timeoutms);  // A step may need a longer timeout
 		}
-	}while(!in_file.eof());
-
-	if(mismatch_count){
-		if(ignore_count){
-			std::cout << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched, " << ignore_count << " ignored" << std::endl;
-		}else{
-			std::cout << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched" << std::endl;
+		if(step_params.use_dryrun){
+			estimate_cmd(&step_params, &est);
+			est_total_us += est.line_us + est.wait_us + est.prog_us;
 		}
-	}else{
-		if(ignore_count){
-			std::cout << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched, " << ignore_count <<  " ignored" << std::endl;
-		}else{
-			std::cout << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched" << std::endl;
+
+		is_detect = (step_params.mcu_name == MCU_PROFILE_AUTO);
+		try{
+			is_passed = run_cmd(&step_params, arg_serial_com);
+			if(is_detect){
+				arg_params->mcu_name = step_params.mcu_name;  // Keep a detected MCU for the next steps
+			}
+			arg_params->max_baud = step_params.max_baud;  // Keep a lowered baud rate, the talker runs at it
+			arg_params->frame_seq = step_params.frame_seq;
+		}catch(tru_exception &ex){
+			*arg_params->out << std::endl << "JOB FAILED! Step " << i + 1 << " of " << step_lines.size() << " failed" << std::endl;
+			throw;
 		}
-	}
-}
 
-bool prog_prompt_write(uint8_t arg_write_cmd_code){
-	switch(arg_write_cmd_code){
-		case TALKER_WRITE_EE_CMD:
-			std::cout << "EEPROM PROGRAMMING CONFIRMATION:" << std::endl;
-			std::cout << "Note, current content will be lost, are you sure you want to write (y/[n])? ";
-			break;
-		case TALKER_WRITE_E_CMD:
-		case TALKER_WRITE_E20_CMD:
-			std::cout << "EPROM PROGRAMMING CONFIRMATION:" << std::endl;
-			std::cout << "Note, programmed zero bits will become permanent, if yes, please apply the" << std::endl;
-			std::cout << "programming voltage (12V) on VPPE pin now before continuing, are you sure " << std::endl;
-			std::cout << "you want to write (y/[n])? ";
-			break;
+		*arg_params->out << std::endl;
 	}
 
-	char buf[256];
-	if(fgets(buf, sizeof(buf), stdin) != NULL){
-		if(buf[0] == 'y'){
-			return true;
-		}
+	if(!is_passed){
+		*arg_params->out << "JOB FAILED! Step " << i << " of " << step_lines.size() << " failed" << std::endl;
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_JOB_FAILED_ID, app_error_string::messages[APP_ERROR_JOB_FAILED_ID], step_lines[i - 1]);
 	}
 
-	return false;
+	if(est_total_us){
+		*arg_params->out << "Job estimate " << est_time_str(est_total_us) << std::endl;
+	}
+	*arg_params->out << "JOB PASSED. " << step_lines.size() << " steps completed" << std::endl;
 }
 
 bool process_cmd_line(cl_my_params *arg_params){
 	serial_com serial;
 
-	serial.open_handle(arg_params->dev_path);  // Open serial COM port
-	serial.set_timeout(arg_params->timeoutms);  // Set serial COM port timeout
-	serial.purge();  // Clear buffer
-
-	switch(arg_params->cmd){
-		case CMD_UPTALKER:
-			if(arg_params->use_fast){
-				serial.set_params(7618, 8, NOPARITY, ONESTOPBIT, false);  // Set to bootloader ROM port settings
-			}else{
-				serial.set_params(1200, 8, NOPARITY, ONESTOPBIT, false);  // Set to bootloader ROM port settings
-			}
-
-			send_control_program(arg_params, &serial);  // Download custom EEPROM control program to MCU RAM
-			std::cout << "Download completed successfully" << std::endl;
+	// A dry run only estimates, the port is not opened
+	if(!arg_params->use_dryrun){
+		serial.open_handle(arg_params->dev_path);  // Open serial COM port
+		serial.set_timeout(arg_params->timeoutms);  // Set serial COM port timeout
+		serial.purge();  // Clear buffer
+	}
 
+	if(arg_params->cmd == CMD_DAEMON){
 #if defined(WIN32) || defined(WIN64)
-			Sleep(75);  // We need to wait a bit for the downloaded program to become ready
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_DAEMON_ID, app_error_string::messages[APP_ERROR_DAEMON_ID], "");
 #else
-			usleep(75000);  // We need to wait a bit for the downloaded program to become ready
+		run_daemon(arg_params, &serial);
 #endif
-
-			serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-
-			break;
-		case CMD_READ:
-			serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-			std::cout << "Reading memory" << std::endl;
-			readmem(arg_params, &serial);
-
-			break;
-		case CMD_READ_VERIFY:
-			serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-			std::cout << "Reading & verifying memory" << std::endl;
-			readmem_verify(arg_params, &serial);
-
-			break;
-		case CMD_WRITE_NORMAL_HEXSTR:
-			serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-			std::cout << "Writing normal memory" << std::endl;
-			writemem_hexstr(arg_params, &serial, TALKER_WRITE_CMD);
-
-			break;
-		case CMD_WRITE_EE_HEXSTR:
-			if(prog_prompt_write(TALKER_WRITE_EE_CMD)){
-				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-				std::cout << "Writing EEPROM" << std::endl;
-				writemem_hexstr(arg_params, &serial, TALKER_WRITE_EE_CMD);
-			}
-
-			break;
-		case CMD_WRITE_NORMAL:
-			serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-			std::cout << "Writing & verifying normal memory" << std::endl;
-			writemem_file(arg_params, &serial, TALKER_WRITE_CMD);
-
-			break;
-		case CMD_WRITE_EE:
-			if(prog_prompt_write(TALKER_WRITE_EE_CMD)){
-				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-				std::cout << "Writing & verifying EEPROM" << std::endl;
-				writemem_file(arg_params, &serial, TALKER_WRITE_EE_CMD);
-			}
-
-			break;
-		case CMD_WRITE_E:
-			if(prog_prompt_write(TALKER_WRITE_E_CMD)){
-				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-				std::cout << "Writing & verifying EPROM (non E20)" << std::endl;
-				writemem_file(arg_params, &serial, TALKER_WRITE_E_CMD);
-				std::cout << "Please remove programming voltage (12V) now before powering of the MCU" << std::endl;
-			}
-
-			break;
-		case CMD_WRITE_E20:
-			if(prog_prompt_write(TALKER_WRITE_E20_CMD)){
-				serial.set_params(9600, 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
-				std::cout << "Writing & verifying EPROM (E20, 12V)" << std::endl;
-				writemem_file(arg_params, &serial, TALKER_WRITE_E20_CMD);
-				std::cout << "Please remove programming voltage (12V) now before powering of the MCU" << std::endl;
-			}
-
-			break;
+	}else if(arg_params->cmd == CMD_JOB){
+		run_job(arg_params, &serial);
+	}else if(!run_cmd(arg_params, &serial)){
+		// A verify mismatch or a declined confirmation, the exit code is not 0 as for a failed job
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_CMD_FAILED_ID, app_error_string::messages[APP_ERROR_CMD_FAILED_ID], "");
 	}
 
 	return true;
@@ -0,0 +1,91 @@
+#include "mcu_profile.h"
+#include <cctype>
+
+// Region shorthands
+#define REGION_RAM(end)              { MEM_RAM,    0x0000, end,    256, true }
+#define REGION_CONFIG                { MEM_CONFIG, 0x103f, 0x103f, 1,   true }
+#define REGION_REG(end)              { MEM_REG,    0x1000, end,    end - 0x1000 + 1, false }
+#define REGION_EEPROM(start, end)    { MEM_EEPROM, start,  end,    256, true }
+#define REGION_EPROM(start, end)     { MEM_EPROM,  start,  end,    256, true }
+#define REGION_ROM(start, end)       { MEM_ROM,    start,  end,    256, true }
+
+static const mcu_profile mcu_profiles[] = {
+	{ "A1",     256,  CMD_NONE,      5, { REGION_RAM(0x00ff), REGION_CONFIG, REGION_REG(0x103f), REGION_EEPROM(0xb600, 0xb7ff), REGION_ROM(0xbf40, 0xbfff) } },
+	{ "811E2",  256,  CMD_NONE,      5, { REGION_RAM(0x00ff), REGION_CONFIG, REGION_REG(0x103f), REGION_ROM(0xbf40, 0xbfff), REGION_EEPROM(0xf800, 0xffff) } },
+	{ "E1",     512,  CMD_NONE,      5, { REGION_RAM(0x01ff), REGION_CONFIG, REGION_REG(0x103f), REGION_EEPROM(0xb600, 0xb7ff), REGION_ROM(0xbf00, 0xbfff) } },
+	{ "E9",     512,  CMD_NONE,      6, { REGION_RAM(0x01ff), REGION_CONFIG, REGION_REG(0x103f), REGION_EEPROM(0xb600, 0xb7ff), REGION_ROM(0xbf00, 0xbfff), REGION_ROM(0xd000, 0xffff) } },
+	{ "711E9",  512,  CMD_WRITE_E,   6, { REGION_RAM(0x01ff), REGION_CONFIG, REGION_REG(0x103f), REGION_EEPROM(0xb600, 0xb7ff), REGION_ROM(0xbf00, 0xbfff), REGION_EPROM(0xd000, 0xffff) } },
+	{ "E20",    768,  CMD_NONE,      7, { REGION_RAM(0x02ff), REGION_CONFIG, REGION_REG(0x103f), REGION_ROM(0x9000, 0xafff), REGION_EEPROM(0xb600, 0xb7ff), REGION_ROM(0xbf00, 0xbfff), REGION_ROM(0xd000, 0xffff) } },
+	{ "711E20", 768,  CMD_WRITE_E20, 7, { REGION_RAM(0x02ff), REGION_CONFIG, REGION_REG(0x103f), REGION_EPROM(0x9000, 0xafff), REGION_EEPROM(0xb600, 0xb7ff), REGION_ROM(0xbf00, 0xbfff), REGION_EPROM(0xd000, 0xffff) } },
+	{ "F1",     1024, CMD_NONE,      5, { REGION_RAM(0x03ff), REGION_CONFIG, REGION_REG(0x105f), REGION_ROM(0xbf00, 0xbfff), REGION_EEPROM(0xfe00, 0xffff) } }
+};
+
+// Find a profile by name (case insensitive), the MC68HC or MC68HC11 prefix is optional.  Returns NULL if not found
+const mcu_profile *mcu_profile_find(std::string name){
+	size_t i;
+
+	for(i = 0; i < name.size(); i++){
+		name[i] = (char)toupper((unsigned char)name[i]);
+	}
+	if(name.compare(0, 6, "MC68HC") == 0){
+		name.erase(0, 6);
+	}
+	if(name.compare(0, 2, "11") == 0){
+		name.erase(0, 2);  // e.g. 11E9 -> E9
+	}
+
+	for(i = 0; i < sizeof(mcu_profiles) / sizeof(mcu_profiles[0]); i++){
+		if(name == mcu_profiles[i].name){
+			return &mcu_profiles[i];
+		}
+	}
+
+	return NULL;
+}
+
+// Find the region containing an address.  Returns NULL for an unmapped address (external memory or a hole)
+const mcu_region *mcu_profile_find_region(const mcu_profile *profile, uint16_t addr){
+	uint8_t i;
+
+	for(i = 0; i < profile->region_count; i++){
+		if(addr >= profile->regions[i].start_addr && addr <= profile->regions[i].end_addr){
+			return &profile->regions[i];
+		}
+	}
+
+	return NULL;
+}
+
+const char *mcu_mem_type_str(mem_type type){
+	switch(type){
+		case MEM_RAM:
+			return "RAM";
+		case MEM_REG:
+			return "register";
+		case MEM_CONFIG:
+			return "CONFIG";
+		case MEM_EEPROM:
+			return "EEPROM";
+		case MEM_EPROM:
+			return "EPROM";
+		case MEM_ROM:
+			return "ROM";
+	}
+
+	return "";
+}
+
+// List of the profile names, e.g. for the usage
+std::string mcu_profile_names(){
+	size_t i;
+	std::string names;
+
+	for(i = 0; i < sizeof(mcu_profiles) / sizeof(mcu_profiles[0]); i++){
+		if(i > 0){
+			names += ", ";
+		}
+		names += mcu_profiles[i].name;
+	}
+
+	return names;
+}
@@ -0,0 +1,44 @@
+#ifndef MCU_PROFILE_H
+#define MCU_PROFILE_H
+
+#include "cmd_line.h"
+#include <cstdint>
+#include <string>
+
+#define MCU_MAX_REGION_COUNT 8
+#define MCU_PROFILE_AUTO     "auto"  // Detect the MCU once the talker is running
+
+// Memory region types
+typedef enum{
+	MEM_RAM,
+	MEM_REG,
+	MEM_CONFIG,
+	MEM_EEPROM,
+	MEM_EPROM,
+	MEM_ROM
+}mem_type;
+
+typedef struct{
+	mem_type type;
+	uint16_t start_addr;
+	uint16_t end_addr;  // Inclusive
+	uint16_t max_chunk_len;  // Maximum bytes per talker read/write command in this region
+	bool is_read_all;  // Included in read all (reading some registers, e.g. SCSR + SCDR, upsets the talker)
+}mcu_region;
+
+// Memory map of a MCU in bootstrap mode, with the default register block and EEPROM addresses.  Regions are searched
+// in order so a smaller region inside a larger one (CONFIG inside the register block) must come first
+typedef struct{
+	const char *name;
+	uint32_t ram_size;
+	unsigned char eprom_cmd;  // Command that programs the EPROM, CMD_NONE if the MCU has no EPROM
+	uint8_t region_count;
+	mcu_region regions[MCU_MAX_REGION_COUNT];
+}mcu_profile;
+
+const mcu_profile *mcu_profile_find(std::string name);
+const mcu_region *mcu_profile_find_region(const mcu_profile *profile, uint16_t addr);
+const char *mcu_mem_type_str(mem_type type);
+std::string mcu_profile_names();
+
+#endif
@@ -37,6 +37,7 @@ serial_com::serial_com() :
 	is_rd_timed_out(false){
 	dcb.DCBlength = sizeof(dcb);
 	memset(&timeouts, 0, sizeof(timeouts));
+	memset(&line_errors, 0, sizeof(line_errors));
 }
 
 serial_com::~serial_com(){
@@ -372,6 +373,36 @@ void serial_com::purge(){
 	}
 }
 
+// Change the parity after the bytes already written are sent, e.g. the 9th bit of multi-drop with mark and space parity
+void serial_com::set_parity(uint8_t parity){
+	if(!FlushFileBuffers(fd)){
+		throw tru_exception::get_os_last_error(__func__, "");
+	}
+
+	dcb.Parity = parity;
+	dcb.fParity = (parity == NOPARITY) ? false : true;
+	if(!SetCommState(fd, &dcb)){
+		throw tru_exception::get_os_last_error(__func__, "");
+	}
+}
+
+// Windows only has error flags, so each flag set since the last call counts as one error
+bool serial_com::get_line_errors(serial_line_errors *errors){
+	DWORD com_errors;
+	COMSTAT com_stat;
+
+	if(!ClearCommError(fd, &com_errors, &com_stat)){
+		return false;
+	}
+	line_errors.frame += (com_errors & CE_FRAME) ? 1 : 0;
+	line_errors.overrun += ((com_errors & CE_OVERRUN) ? 1 : 0) + ((com_errors & CE_RXOVER) ? 1 : 0);
+	line_errors.parity += (com_errors & CE_RXPARITY) ? 1 : 0;
+	line_errors.brk += (com_errors & CE_BREAK) ? 1 : 0;
+	*errors = line_errors;
+
+	return true;
+}
+
 #else
 
 // =====
@@ -379,6 +410,9 @@ void serial_com::purge(){
 // =====
 
 #include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>  // TIOCGICOUNT counters
+#endif
 
 serial_com::serial_com() :
 	fd(-1){
@@ -445,6 +479,31 @@ uint8_t serial_com::byte_size_to_code(uint8_t byte_size){
 	return CS5;
 }
 
+// Returns the control flags with the parity bits for the parity, mark and space need CMSPAR (Linux) else throws
+tcflag_t serial_com::parity_to_code(tcflag_t cflag, uint8_t parity){
+	cflag &= ~(PARENB | PARODD);
+#ifdef CMSPAR
+	cflag &= ~CMSPAR;
+#endif
+
+	switch(parity){
+		case ODDPARITY:
+			return cflag | PARENB | PARODD;
+		case EVENPARITY:
+			return cflag | PARENB;
+#ifdef CMSPAR
+		case MARKPARITY:
+			return cflag | PARENB | PARODD | CMSPAR;
+		case SPACEPARITY:
+			return cflag | PARENB | CMSPAR;
+#endif
+		case NOPARITY:
+			return cflag;
+		default:
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, SERIALCOMM_ERROR_PARITY_ID, serialcomm_error_string::messages[SERIALCOMM_ERROR_PARITY_ID], std::to_string(parity));
+	}
+}
+
 void serial_com::set_params(uint32_t baud_rate, uint8_t byte_size, uint8_t parity, uint8_t stop_bits, bool rtscts_en){
 	// Set port settings using termios
 	struct termios tio;
@@ -453,14 +512,14 @@ void serial_com::set_params(uint32_t baud_rate, uint8_t byte_size, uint8_t parit
 	tio.c_cflag &= ~CSIZE;  // Clear all the size bits first
 	tio.c_cflag |= byte_size_to_code(byte_size);  // Set number of bits per byte
 	//tio.c_cflag |= byte_size;  // Set number of bits per byte
-	tio.c_cflag = (parity == NOPARITY) ? tio.c_cflag & ~PARENB : tio.c_cflag | PARENB;  // Set parity on or off
+	tio.c_cflag = parity_to_code(tio.c_cflag, parity);  // Set parity
 	tio.c_cflag = (stop_bits == TWOSTOPBITS) ? tio.c_cflag | CSTOPB : tio.c_cflag & ~CSTOPB;  // Set two stop bits else one stop bit
 	tio.c_cflag = rtscts_en ? tio.c_cflag | CRTSCTS : tio.c_cflag & ~CRTSCTS;  // Set hardware RTS/CTS flow control
 	tio.c_iflag &= ~(IXON | IXOFF | IXANY);  // Turn off software flow control
 	// Turn off settings that might interfere with send and receive raw binary bytes
 	tio.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
 	tio.c_lflag &= ~(ECHO | ~ECHOE | ECHONL | ICANON | ISIG | IEXTEN);
-	tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL); // Disable any special handling of received bytes
+	tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | INPCK); // Disable any special handling of received bytes
 	tio.c_oflag &= ~(ONLCR | OCRNL | OPOST);
 	//tio.c_oflag &= ~OXTABS;  // Prevent conversion of tabs to spaces (NOT PRESENT IN LINUX)
 	//tio.c_oflag &= ~ONOEOT;  // Prevent removal of C-d chars (0x004) in output (NOT PRESENT IN LINUX)
@@ -471,6 +530,20 @@ void serial_com::set_params(uint32_t baud_rate, uint8_t byte_size, uint8_t parit
 	if(tcsetattr(fd, TCSANOW, &tio)) throw tru_exception::get_clib_last_error(__func__, "");
 }
 
+// Change the parity after the bytes already written are sent, e.g. the 9th bit of multi-drop with mark and space parity
+void serial_com::set_parity(uint8_t parity){
+	struct termios tio;
+
+	if(tcgetattr(fd, &tio)){
+		throw tru_exception::get_clib_last_error(__func__, "");
+	}
+
+	tio.c_cflag = parity_to_code(tio.c_cflag, parity);
+	if(tcsetattr(fd, TCSADRAIN, &tio)){
+		throw tru_exception::get_clib_last_error(__func__, "");
+	}
+}
+
 void serial_com::set_timeout(uint32_t timeout_ms){
 	struct termios tio;
 
@@ -591,4 +664,25 @@ ssize_t serial_com::write_port(void *buf, uint32_t len){
 	return n;
 }
 
+// The driver's receive error counters, they only count up so compare them before and after an operation
+// Returns false if the driver has no counters, e.g. a pseudo terminal
+bool serial_com::get_line_errors(serial_line_errors *errors){
+#ifdef TIOCGICOUNT
+	struct serial_icounter_struct icount;
+
+	if(ioctl(fd, TIOCGICOUNT, &icount)){
+		return false;
+	}
+	errors->frame = icount.frame;
+	errors->overrun = icount.overrun + icount.buf_overrun;
+	errors->parity = icount.parity;
+	errors->brk = icount.brk;
+
+	return true;
+#else
+	(void)errors;  // Suppress unreferenced warning
+	return false;
+#endif
+}
+
 #endif
@@ -39,6 +39,16 @@
 #ifndef SERIAL_COM_H
 #define SERIAL_COM_H
 
+#include <cstdint>
+
+// Receive line error counters, see get_line_errors()
+typedef struct{
+	uint32_t frame;
+	uint32_t overrun;  // UART and driver buffer overruns
+	uint32_t parity;
+	uint32_t brk;
+}serial_line_errors;
+
 #if defined(WIN32) || defined(WIN64)
 
 // =======
@@ -61,6 +71,7 @@ protected:
 	DCB dcb;  // Win32 serial com parameters
 	COMMTIMEOUTS timeouts;
 	bool is_rd_timed_out;
+	serial_line_errors line_errors;  // Errors seen by get_line_errors()
 
 public:
 	serial_com();
@@ -74,6 +85,8 @@ public:
 	DWORD read_port(void *buf, uint32_t len);
 	DWORD write_port(void *buf, uint32_t len);
 	void purge();
+	void set_parity(uint8_t parity);
+	bool get_line_errors(serial_line_errors *errors);
 };
 
 #else
@@ -115,12 +128,15 @@ public:
 	void clear_comm_error();
 	speed_t baud_rate_to_code(uint32_t baud_rate);
 	uint8_t byte_size_to_code(uint8_t byte_size);
+	tcflag_t parity_to_code(tcflag_t cflag, uint8_t parity);
 	void set_params(uint32_t baud_rate, uint8_t byte_size, uint8_t parity, uint8_t stop_bits, bool rtscts_en);
 	void set_timeout(uint32_t timeout_ms);
 	void set_wait(uint32_t min_chars);
+	void set_parity(uint8_t parity);
 	void purge();
 	ssize_t read_port(void *buf, uint32_t len);
 	ssize_t write_port(void *buf, uint32_t len);
+	bool get_line_errors(serial_line_errors *errors);
 };
 
 #endif
@@ -132,7 +148,8 @@ public:
 // Serial comm custom error message list
 #define SERIALCOMM_ERROR_LIST(item) \
 	item(SERIALCOMM_ERROR_WAITABANDONED_ID, "Wait abandoned") \
-	item(SERIALCOMM_ERROR_TIMEDOUT_ID, "Timed out")
+	item(SERIALCOMM_ERROR_TIMEDOUT_ID, "Timed out") \
+	item(SERIALCOMM_ERROR_PARITY_ID, "Parity not supported")
 
 // Create enum from error message list
 CREATE_ENUM(serialcomm_error_e, SERIALCOMM_ERROR_LIST)
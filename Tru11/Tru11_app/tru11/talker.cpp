@@ -0,0 +1,3081 @@
+#include "talker.h"
+#include "app_error_string.h"
+#include "tru_exception.h"
+#include "to_string.h"
+#include "my_buf.h"
+#include "my_file.h"
+#include "mcu_profile.h"
+#include <stdio.h>
+#include <cstring>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <format>
+#include <filesystem>
+#include <chrono>
+
+// For the Sleep/sleep function
+#if defined(WIN32) || defined(WIN64)
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// The previous read for read sync=y
+typedef struct{
+	std::vector<int16_t> bytes;  // Indexed by address, -1 = not in the file
+	uint32_t byte_count;
+	uint32_t fetched_count;  // Bytes read because they changed or were not in the file
+	uint32_t rx_count;  // Bytes received from the talker, including the echoes and checksums
+}sync_image;
+
+// The progress of a file write, saved to the journal= file
+typedef struct{
+	std::string id;  // Write command and image checksum, the journal of another image is ignored
+	int32_t marks[JOURNAL_REGION_COUNT];  // Last verified address of each region, -1 = none
+	int32_t last_addrs[JOURNAL_REGION_COUNT];  // Last address of the region's previous block in the file, -1 = none
+	bool is_frozen[JOURNAL_REGION_COUNT];  // A block failed or was out of order, the mark is not advanced any more
+	bool is_resumed;
+	uint32_t skip_count;  // Bytes verified by a previous run and not written again
+}write_journal;
+
+// Call the progress hook, if there is one
+void report_progress(cl_my_params *arg_params, uint32_t arg_done, uint32_t arg_total){
+	if(arg_params->on_progress){
+		arg_params->on_progress(arg_done, arg_total);
+	}
+}
+
+// Sum of the receive line error counters, 0 when the driver has none
+uint32_t line_error_count(serial_com *arg_serial_com){
+	serial_line_errors errors;
+
+	if(!arg_serial_com->get_line_errors(&errors)){
+		return 0;
+	}
+
+	return errors.frame + errors.overrun + errors.parity + errors.brk;
+}
+
+// Print the receive line errors since arg_before, if any
+void print_line_errors(cl_my_params *arg_params, serial_com *arg_serial_com, serial_line_errors *arg_before){
+	serial_line_errors errors;
+
+	if(!arg_serial_com->get_line_errors(&errors)){
+		return;
+	}
+	errors.frame -= arg_before->frame;
+	errors.overrun -= arg_before->overrun;
+	errors.parity -= arg_before->parity;
+	errors.brk -= arg_before->brk;
+	if(errors.frame || errors.overrun || errors.parity || errors.brk){
+		*arg_params->out << "Line errors: frame " << errors.frame << ", overrun " << errors.overrun << ", parity " << errors.parity << ", break " << errors.brk << std::endl;
+	}
+}
+
+// Count the data bytes of the S1 records of a file
+uint32_t get_srec_data_count(std::string arg_file_name){
+	cl_my_file in_file;
+	std::string line_str;
+	uint32_t total_databytes = 0;
+
+	in_file.open_file(arg_file_name, "rb");
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			total_databytes += (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+		}
+	}while(!in_file.eof());
+
+	return total_databytes;
+}
+
+// Generic transmit in blocks
+void tx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint32_t arg_len){
+	uint8_t *txbuf_p = arg_txbuf;
+	uint32_t chunklen = 0;
+	uint32_t xferredlen;
+	uint32_t remaining;
+
+	remaining = arg_len;
+	while(remaining){
+		chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
+		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
+		if(xferredlen != chunklen){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+		}
+		txbuf_p += chunklen;
+		remaining -= chunklen;
+	}
+}
+
+// Generic receive in blocks
+void rx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint8_t *rxbuf_p = arg_rxbuf;
+	uint32_t chunklen = 0;
+	uint32_t xferredlen;
+	uint32_t remaining;
+
+	remaining = arg_len;
+	while(remaining){
+		chunklen = (remaining > arg_params->serial_rxbuf_size) ? arg_params->serial_rxbuf_size : remaining;
+		xferredlen = arg_serial_com->read_port(rxbuf_p, chunklen);
+		if(xferredlen != chunklen){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_RX_FAIL_ID, app_error_string::messages[APP_ERROR_RX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+		}
+
+		rxbuf_p += chunklen;
+		remaining -= chunklen;
+	}
+}
+
+// Receive a run-length encoded chunk and decode it, see the talker read memory run-length encoded command
+// Two equal bytes in a row are followed by a repeat count of how many more times the byte appears
+void rx_rle_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint8_t *rxbuf_p = arg_rxbuf;
+	uint32_t remaining;
+	uint8_t rxbyte;
+	uint8_t repeat_count;
+	bool is_prev_valid = false;
+
+	remaining = arg_len;
+	while(remaining){
+		rx_chunk(arg_params, arg_serial_com, &rxbyte, 1);
+		*rxbuf_p++ = rxbyte;
+		remaining--;
+
+		// Second of a pair, a repeat count follows
+		if(is_prev_valid && rxbyte == rxbuf_p[-2]){
+			rx_chunk(arg_params, arg_serial_com, &repeat_count, 1);
+			if(repeat_count > remaining){
+				throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_RLE_ID, app_error_string::messages[APP_ERROR_RLE_ID], std::format(app_error_string::messages[APP_ERROR_RLE_INFO_ID], repeat_count, remaining));
+			}
+			memset(rxbuf_p, rxbyte, repeat_count);
+			rxbuf_p += repeat_count;
+			remaining -= repeat_count;
+			is_prev_valid = false;
+		}else{
+			is_prev_valid = true;
+		}
+	}
+}
+
+void verify_echo(uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len){
+	for(uint32_t i = 0; i < arg_len; i++){
+		if(arg_txbuf[i] != arg_rxbuf[i]){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_ECHO_ID, app_error_string::messages[APP_ERROR_ECHO_ID], std::format(app_error_string::messages[APP_ERROR_ECHO_INFO_ID], arg_txbuf[i], arg_rxbuf[i]));
+		}
+	}
+}
+
+// Generic transmit and receive in blocks
+void txrx_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len, bool arg_verify_echo){
+	uint8_t *txbuf_p = arg_txbuf;
+	uint8_t *rxbuf_p = arg_rxbuf;
+	uint32_t chunklen = 0;
+	uint32_t xferredlen;
+	uint32_t remaining;
+
+	remaining = arg_len;
+	while(remaining){
+		chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
+
+		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
+		if(xferredlen != chunklen){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+		}
+
+		rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
+		if(arg_verify_echo){
+			verify_echo(txbuf_p, rxbuf_p, chunklen);
+		}
+
+		txbuf_p += chunklen;
+		rxbuf_p += chunklen;
+		remaining -= chunklen;
+	}
+}
+
+// Transmit and receive in blocks specifically for downloading the control program
+void txrx_chunk_control_program(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint8_t *txbuf_p = arg_txbuf;
+	uint8_t *rxbuf_p = arg_rxbuf;
+	uint32_t chunklen = 0;
+	uint32_t xferredlen;
+	uint32_t remaining;
+
+	remaining = arg_len;
+	while(remaining){
+		chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
+		remaining -= chunklen;
+
+		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
+		if(xferredlen != chunklen){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+		}
+
+		// Note this problem is to do with the use serial no control flow and the bootloader's baud rate changing scheme
+		// For the last byte: some USB to TTL serial adapters will not receive the last echoed byte
+		if(remaining == 0){
+			if(chunklen == 1){
+				// Note: some adapters will not receive the last echoed byte, if so we will ignore the error
+				// Read the last byte
+				try{
+					xferredlen = arg_serial_com->read_port(rxbuf_p, chunklen);
+					verify_echo(txbuf_p, rxbuf_p, chunklen);
+				}catch(tru_exception &ex){
+					(void)ex;  // Suppress unreferenced warning
+				}
+			}else{
+				// A workaround for some adapters, since last byte is missing we read one less normally
+				rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen - 1);
+				verify_echo(txbuf_p, rxbuf_p, chunklen - 1);
+
+				// Note: some adapters will not receive the last echoed byte, if so we will ignore the error
+				// Read the last byte
+				try{
+					xferredlen = arg_serial_com->read_port(rxbuf_p + chunklen - 1, 1);
+					verify_echo(txbuf_p, rxbuf_p + chunklen - 1, 1);
+				}catch(tru_exception &ex){
+					(void)ex;  // Suppress unreferenced warning
+				}
+			}
+		}else{
+			rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
+			verify_echo(txbuf_p, rxbuf_p, chunklen);
+		}
+
+		txbuf_p += chunklen;
+		rxbuf_p += chunklen;
+	}
+}
+
+// Transmit and receive in blocks specifically for writing memory
+void txrx_chunk_write(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len, bool arg_is_prog){
+	uint8_t *txbuf_p = arg_txbuf;
+	uint8_t *rxbuf_p = arg_rxbuf;
+	uint32_t chunklen = 0;
+	uint32_t xferredlen;
+	uint32_t remaining;
+
+	remaining = arg_len;
+	while(remaining){
+		if(arg_is_prog){
+			chunklen = (remaining > arg_params->serial_prog_txbuf_size) ? arg_params->serial_prog_txbuf_size : remaining;
+		}else{
+			chunklen = (remaining > arg_params->serial_txbuf_size) ? arg_params->serial_txbuf_size : remaining;
+		}
+		remaining -= chunklen;
+
+		xferredlen = arg_serial_com->write_port(txbuf_p, chunklen);
+		if(xferredlen != chunklen){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TX_FAIL_ID, app_error_string::messages[APP_ERROR_TX_FAIL_ID], std::format(app_error_string::messages[APP_ERROR_XFER_INFO_ID], chunklen, xferredlen));
+		}
+
+		rx_chunk(arg_params, arg_serial_com, rxbuf_p, chunklen);
+
+		txbuf_p += chunklen;
+		rxbuf_p += chunklen;
+	}
+}
+
+// Transmit a chunk run-length encoded for the talker write compressed command, see the talker for the protocol
+// Returns the talker's 16-bit checksum of the bytes reread after writing
+// Note: we must wait for the talker's reply after each run, and for each byte when programming
+uint16_t txrx_rle_chunk_write(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t *arg_txbuf, uint32_t arg_len, bool arg_is_prog){
+	uint32_t i = 0;
+	uint32_t run;
+	uint8_t txbyte;
+	uint8_t rxbyte[2];
+
+	while(i < arg_len){
+		// Find the run length of the byte, limited to what a repeat count can hold
+		run = 1;
+		while(i + run < arg_len && run < 257 && arg_txbuf[i + run] == arg_txbuf[i]){
+			run++;
+		}
+
+		// The first byte of a run is sent the same as a single byte
+		txbyte = arg_txbuf[i];
+		tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
+		if(arg_is_prog){
+			rx_chunk(arg_params, arg_serial_com, rxbyte, 1);
+		}
+
+		// The byte again followed by the repeat count
+		if(run >= 2){
+			tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
+			txbyte = (uint8_t)(run - 2);
+			tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
+
+			// Programming a run takes longer than the timeout, so extend it while waiting for the reply
+			if(arg_is_prog){
+				arg_serial_com->set_timeout(arg_params->timeoutms + run * TALKER_PROG_DELAY_MS);
+				rx_chunk(arg_params, arg_serial_com, rxbyte, 1);
+				arg_serial_com->set_timeout(arg_params->timeoutms);
+			}else{
+				rx_chunk(arg_params, arg_serial_com, rxbyte, 1);
+			}
+		}
+
+		i += run;
+	}
+
+	rx_chunk(arg_params, arg_serial_com, rxbyte, 2);
+
+	return (uint16_t)(rxbyte[0] << 8 | rxbyte[1]);
+}
+
+// Send the identify command, returns true if the talker replied
+bool identify_talker(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint8_t txbyte = TALKER_IDENT_CMD;
+	uint8_t rxbuf[3];
+	bool is_running = false;
+
+	arg_serial_com->set_timeout(TALKER_PING_TIMEOUT_MS);
+	try{
+		tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
+		rx_chunk(arg_params, arg_serial_com, rxbuf, 3);
+		is_running = (rxbuf[0] == TALKER_IDENT_CMD);
+	}catch(tru_exception &ex){
+		(void)ex;  // Suppress unreferenced warning, no reply means the talker is not running
+	}
+	arg_serial_com->set_timeout(arg_params->timeoutms);
+
+	if(is_running){
+		*arg_params->out << "Talker version " << (uint16_t)rxbuf[1] << " (" << (uint16_t)rxbuf[2] * 256 << " bytes RAM) is running" << std::endl;
+	}
+
+	return is_running;
+}
+
+// Clear any unexpected bytes and send the identify command, returns true if the talker replied
+bool ping_talker(cl_my_params *arg_params, serial_com *arg_serial_com){
+	arg_serial_com->purge();
+
+	return identify_talker(arg_params, arg_serial_com);
+}
+
+// Poll the talker until it replies, instead of waiting a fixed time after the download
+void wait_talker_ready(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint32_t retries = arg_params->timeoutms / TALKER_PING_TIMEOUT_MS + 1;
+
+	while(!ping_talker(arg_params, arg_serial_com)){
+		if(--retries == 0){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TALKER_NO_REPLY_ID, app_error_string::messages[APP_ERROR_TALKER_NO_REPLY_ID], "");
+		}
+	}
+}
+
+// CRC-16 with the CCITT polynomial 0x1021 and initial value 0xffff, the same as the talker framed command
+uint16_t crc16(const uint8_t *arg_buf, uint32_t arg_len){
+	uint16_t crc = 0xffff;
+
+	for(uint32_t i = 0; i < arg_len; i++){
+		crc ^= (uint16_t)(arg_buf[i] << 8);
+		for(uint8_t bit = 0; bit < 8; bit++){
+			crc = (crc & 0x8000) ? (uint16_t)(crc << 1 ^ 0x1021) : (uint16_t)(crc << 1);
+		}
+	}
+
+	return crc;
+}
+
+// Checksum of a block, the same as the talker checksum command
+uint16_t talker_checksum(const uint8_t *arg_buf, uint32_t arg_len){
+	uint8_t sum_lo = 0;
+	uint8_t sum_hi = 0;
+
+	for(uint32_t i = 0; i < arg_len; i++){
+		sum_lo += arg_buf[i];
+		sum_hi += sum_lo;
+	}
+
+	return (uint16_t)(sum_hi << 8 | sum_lo);
+}
+
+// Get the talker back to its command loop after a framing error, by pinging it until it replies.  When the talker may
+// still be waiting for command parameters, fillers are sent first so a write only reaches the timer registers at
+// $1010, instead of the pings ($ff) making the address $ffff.  The caller only asks for fillers when no programming
+// command can be in its data loop (is_prog_data), where they would be programmed as data.  A ping is programmed as
+// $ff there, which leaves EPROM as it is and only erases EEPROM bytes of the chunk that failed
+void resync_talker(cl_my_params *arg_params, serial_com *arg_serial_com, bool arg_is_param){
+	uint8_t fill_buf[TALKER_RESYNC_PARAM_COUNT];
+	uint32_t i;
+
+	*arg_params->out << "Resynchronising with the talker" << std::endl;
+	if(arg_is_param){
+		memset(fill_buf, TALKER_RESYNC_PARAM_BYTE, sizeof(fill_buf));
+		tx_chunk(arg_params, arg_serial_com, fill_buf, sizeof(fill_buf));
+	}
+
+	for(i = 0; i < TALKER_RESYNC_MAX_PINGS; i++){
+		if(ping_talker(arg_params, arg_serial_com)){
+			arg_params->is_prog_data = false;
+			return;
+		}
+	}
+
+	throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TALKER_NO_REPLY_ID, app_error_string::messages[APP_ERROR_TALKER_NO_REPLY_ID], "");
+}
+
+// Transmit a command with the talker framed command, see the talker for the protocol
+// Returns true when the talker acknowledged the header and is running the command, false when it did not and is back
+// in its command loop
+bool tx_frame_header(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_cmd_code, uint32_t arg_len, uint16_t arg_addr){
+	uint8_t txbuf[FRAME_HEADER_LEN];
+	uint8_t rxbyte;
+	uint16_t crc;
+
+	// A failed echo may leave the talker in another command waiting for its parameters
+	txbuf[0] = TALKER_FRAME_CMD;
+	try{
+		txrx_chunk(arg_params, arg_serial_com, txbuf, &rxbyte, 1, true);
+	}catch(tru_exception &ex){
+		*arg_params->out << "Link error: " << ex.get_message() << std::endl;
+		// Fillers only for a frame whose command cannot program, so none are programmed as data during a programming run
+		resync_talker(arg_params, arg_serial_com, arg_cmd_code < TALKER_WRITE_EE_CMD || arg_cmd_code > TALKER_WRITE_E20_CMD);
+		return false;
+	}
+
+	arg_params->frame_seq++;
+	txbuf[0] = arg_params->frame_seq;
+	txbuf[1] = arg_cmd_code;
+	txbuf[2] = (uint8_t)arg_len;
+	txbuf[3] = (uint8_t)(arg_addr >> 8 & 0xff);
+	txbuf[4] = (uint8_t)(arg_addr & 0xff);
+	crc = crc16(txbuf, FRAME_HEADER_LEN - 2);
+	txbuf[5] = (uint8_t)(crc >> 8 & 0xff);
+	txbuf[6] = (uint8_t)(crc & 0xff);
+	tx_chunk(arg_params, arg_serial_com, txbuf, FRAME_HEADER_LEN);
+
+	rx_chunk(arg_params, arg_serial_com, &rxbyte, 1);
+	if(rxbyte == arg_params->frame_seq){
+		return true;
+	}
+	if(rxbyte != (uint8_t)~arg_params->frame_seq){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_FRAME_ID, app_error_string::messages[APP_ERROR_FRAME_ID], std::format(app_error_string::messages[APP_ERROR_FRAME_INFO_ID], arg_params->frame_seq, rxbyte));
+	}
+	*arg_params->out << "Talker NAK for header " << (uint16_t)arg_params->frame_seq << std::endl;
+
+	return false;
+}
+
+// Read a chunk of memory with the framed command, the chunk is checked with the talker checksum command (also framed)
+// and only this chunk is read again until it matches
+void readmem_frame_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint8_t sum_buf[2];
+	uint8_t txbyte = 1;  // Checksum block count
+	uint32_t retries = 0;
+
+	while(true){
+		try{
+			if(tx_frame_header(arg_params, arg_serial_com, arg_params->use_rle ? TALKER_READ_RLE_CMD : TALKER_READ_CMD, arg_len, arg_addr)){
+				if(arg_params->use_rle){
+					rx_rle_chunk(arg_params, arg_serial_com, arg_rxbuf, arg_len);
+				}else{
+					rx_chunk(arg_params, arg_serial_com, arg_rxbuf, arg_len);
+				}
+
+				if(tx_frame_header(arg_params, arg_serial_com, TALKER_SUM_CMD, arg_len, arg_addr)){
+					tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
+					rx_chunk(arg_params, arg_serial_com, sum_buf, 2);
+					if((uint16_t)(sum_buf[0] << 8 | sum_buf[1]) == talker_checksum(arg_rxbuf, arg_len)){
+						return;
+					}
+				}
+			}
+		}catch(tru_exception &ex){
+			*arg_params->out << "Link error: " << ex.get_message() << std::endl;
+			resync_talker(arg_params, arg_serial_com, false);
+		}
+
+		if(++retries > FRAME_MAX_RETRIES){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_FRAME_RETRY_ID, std::format(app_error_string::messages[APP_ERROR_FRAME_RETRY_ID], FRAME_MAX_RETRIES), "");
+		}
+		*arg_params->out << "Retransmitting read of " << arg_len << " byte(s) at " << string_utils_ns::to_string_right_hex_up(arg_addr, 4, '0') << std::endl;
+	}
+}
+
+// Read a chunk of memory, up to TALKER_MAX_BYTE_COUNT
+void readmem_chunk_once(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint8_t param_buf[3];
+
+	if(arg_params->use_frame){
+		readmem_frame_chunk(arg_params, arg_serial_com, arg_addr, arg_rxbuf, arg_len);
+		return;
+	}
+
+	// Transmit command
+	param_buf[0] = arg_params->use_rle ? TALKER_READ_RLE_CMD : TALKER_READ_CMD;
+	txrx_chunk(arg_params, arg_serial_com, param_buf, arg_rxbuf, 1, true);
+
+	// Transmit parameters
+	param_buf[0] = (uint8_t)arg_len;
+	param_buf[1] = (uint8_t)(arg_addr >> 8 & 0xff);
+	param_buf[2] = (uint8_t)(arg_addr & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 3);
+
+	// Read a chunk of memory
+	if(arg_params->use_rle){
+		rx_rle_chunk(arg_params, arg_serial_com, arg_rxbuf, arg_len);
+	}else{
+		rx_chunk(arg_params, arg_serial_com, arg_rxbuf, arg_len);
+	}
+}
+
+// Read a chunk of memory, after a link error with line errors the chunk is read again at a lower baud rate
+void readmem_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint32_t error_mark;
+
+	while(true){
+		error_mark = line_error_count(arg_serial_com);
+		try{
+			readmem_chunk_once(arg_params, arg_serial_com, arg_addr, arg_rxbuf, arg_len);
+			return;
+		}catch(tru_exception &ex){
+			if(!fallback_baud(arg_params, arg_serial_com, &ex, error_mark)){
+				throw;
+			}
+		}
+	}
+}
+
+// Write a chunk with the talker write block command, see the talker for the protocol
+// The chunk is sent in pieces of up to the talker's block buffer size, each at full line rate, and the talker replies
+// with a checksum once it has written them.  Returns true when all the checksums matched
+bool txrx_block_chunk_write(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint32_t arg_len){
+	uint8_t param_buf[4];
+	uint8_t rxbuf[2];
+	uint32_t i = 0;
+	uint32_t j;
+	uint32_t piecelen;
+	uint16_t checksum;
+	bool is_matched = true;
+
+	while(i < arg_len){
+		// Transmit command, the talker replies with its block buffer size
+		param_buf[0] = TALKER_WRITE_BLOCK_CMD;
+		txrx_chunk(arg_params, arg_serial_com, param_buf, rxbuf, 1, true);
+		rx_chunk(arg_params, arg_serial_com, rxbuf, 1);
+		piecelen = rxbuf[0] ? rxbuf[0] : TALKER_MAX_BYTE_COUNT;
+		if(piecelen > arg_len - i){
+			piecelen = arg_len - i;
+		}
+
+		// Transmit parameters and the piece without waiting
+		param_buf[0] = arg_write_cmd_code - TALKER_WRITE_CMD;  // Memory type
+		param_buf[1] = (uint8_t)piecelen;
+		param_buf[2] = (uint8_t)((arg_addr + i) >> 8 & 0xff);
+		param_buf[3] = (uint8_t)((arg_addr + i) & 0xff);
+		tx_chunk(arg_params, arg_serial_com, param_buf, 4);
+		arg_params->is_prog_data = param_buf[0] != 0;
+		tx_chunk(arg_params, arg_serial_com, arg_txbuf + i, piecelen);
+
+		checksum = 0;
+		for(j = 0; j < piecelen; j++){
+			checksum += arg_txbuf[i + j];
+		}
+
+		// Programming the whole piece takes longer than the timeout, so extend it while waiting for the checksum
+		arg_serial_com->set_timeout(arg_params->timeoutms + piecelen * TALKER_PROG_DELAY_MS);
+		rx_chunk(arg_params, arg_serial_com, rxbuf, 2);
+		arg_serial_com->set_timeout(arg_params->timeoutms);
+		arg_params->is_prog_data = false;
+		if((uint16_t)(rxbuf[0] << 8 | rxbuf[1]) != checksum){
+			is_matched = false;
+		}
+
+		i += piecelen;
+	}
+
+	return is_matched;
+}
+
+// Write a chunk of memory with the framed command.  When a byte reread does not match, the chunk is read back (framed)
+// to tell a corrupted reply from a corrupted write, and only this chunk is written again.  After the retries the bytes
+// read back are returned
+void writemem_frame_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint32_t retries = 0;
+
+	while(true){
+		try{
+			if(tx_frame_header(arg_params, arg_serial_com, arg_write_cmd_code, arg_len, arg_addr)){
+				arg_params->is_prog_data = arg_write_cmd_code != TALKER_WRITE_CMD;
+				txrx_chunk_write(arg_params, arg_serial_com, arg_txbuf, arg_rxbuf, arg_len, arg_write_cmd_code != TALKER_WRITE_CMD);
+				arg_params->is_prog_data = false;
+				if(memcmp(arg_rxbuf, arg_txbuf, arg_len) == 0){
+					return;
+				}
+
+				readmem_frame_chunk(arg_params, arg_serial_com, arg_addr, arg_rxbuf, arg_len);
+				if(memcmp(arg_rxbuf, arg_txbuf, arg_len) == 0 || retries == FRAME_MAX_RETRIES){
+					return;
+				}
+			}
+		}catch(tru_exception &ex){
+			*arg_params->out << "Link error: " << ex.get_message() << std::endl;
+			resync_talker(arg_params, arg_serial_com, false);
+		}
+
+		if(++retries > FRAME_MAX_RETRIES){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_FRAME_RETRY_ID, std::format(app_error_string::messages[APP_ERROR_FRAME_RETRY_ID], FRAME_MAX_RETRIES), "");
+		}
+		*arg_params->out << "Retransmitting write of " << arg_len << " byte(s) at " << string_utils_ns::to_string_right_hex_up(arg_addr, 4, '0') << std::endl;
+	}
+}
+
+// Write a chunk of memory, compressed when enabled. For verifying, the bytes reread are returned in the receive buffer
+// When compressed only a checksum is returned, if it does not match we read back the chunk
+void writemem_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len){
+	uint8_t param_buf[4];
+	uint16_t checksum = 0;
+	bool is_matched;
+
+	// Programming with the write block command, which transmits its own command and parameters
+	if(arg_params->use_block && arg_write_cmd_code != TALKER_WRITE_CMD){
+		if(txrx_block_chunk_write(arg_params, arg_serial_com, arg_write_cmd_code, arg_addr, arg_txbuf, arg_len)){
+			memcpy(arg_rxbuf, arg_txbuf, arg_len);
+		}else{
+			// Read back the chunk to find the mismatches
+			readmem_chunk(arg_params, arg_serial_com, arg_addr, arg_rxbuf, arg_len);
+		}
+
+		return;
+	}
+
+	if(arg_params->use_frame && !arg_params->use_compress){
+		writemem_frame_chunk(arg_params, arg_serial_com, arg_write_cmd_code, arg_addr, arg_txbuf, arg_rxbuf, arg_len);
+		return;
+	}
+
+	// Transmit command
+	param_buf[0] = arg_params->use_compress ? TALKER_WRITE_RLE_CMD : arg_write_cmd_code;
+	txrx_chunk(arg_params, arg_serial_com, param_buf, arg_rxbuf, 1, true);
+
+	// Transmit parameters
+	if(arg_params->use_compress){
+		param_buf[0] = arg_write_cmd_code - TALKER_WRITE_CMD;  // Memory type
+		tx_chunk(arg_params, arg_serial_com, param_buf, 1);
+	}
+	param_buf[0] = (uint8_t)arg_len;
+	param_buf[1] = (uint8_t)(arg_addr >> 8 & 0xff);
+	param_buf[2] = (uint8_t)(arg_addr & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 3);
+	arg_params->is_prog_data = arg_write_cmd_code != TALKER_WRITE_CMD;
+
+	// Write and receive a chunk of memory
+	if(arg_params->use_compress){
+		for(uint32_t i = 0; i < arg_len; i++){
+			checksum += arg_txbuf[i];
+		}
+
+		is_matched = txrx_rle_chunk_write(arg_params, arg_serial_com, arg_txbuf, arg_len, arg_write_cmd_code != TALKER_WRITE_CMD) == checksum;
+		arg_params->is_prog_data = false;
+		if(is_matched){
+			memcpy(arg_rxbuf, arg_txbuf, arg_len);
+		}else{
+			// Read back the chunk to find the mismatches
+			readmem_chunk(arg_params, arg_serial_com, arg_addr, arg_rxbuf, arg_len);
+		}
+	}else{
+		txrx_chunk_write(arg_params, arg_serial_com, arg_txbuf, arg_rxbuf, arg_len, arg_write_cmd_code != TALKER_WRITE_CMD);
+		arg_params->is_prog_data = false;
+	}
+}
+
+// Program a chunk of EPROM with the talker write EPROM adaptive command, see the talker for the protocol
+// The bytes reread are returned in the receive buffer and the pulse count of each byte in the pulse buffer
+void writemem_pulse_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint8_t *arg_pulsebuf, uint32_t arg_len){
+	uint8_t param_buf[6];
+	uint8_t rxbyte[2];
+	uint32_t i;
+
+	// Transmit command
+	param_buf[0] = TALKER_WRITE_E_PULSE_CMD;
+	txrx_chunk(arg_params, arg_serial_com, param_buf, rxbyte, 1, true);
+
+	// Transmit parameters
+	param_buf[0] = (uint8_t)(((arg_write_cmd_code == TALKER_WRITE_E20_CMD) ? HC11_EPROG_ADDR : HC11_PPROG_ADDR) & 0xff);  // Programming register offset
+	param_buf[1] = arg_params->pulse_width;
+	param_buf[2] = arg_params->pulse_max;
+	param_buf[3] = (uint8_t)arg_len;
+	param_buf[4] = (uint8_t)(arg_addr >> 8 & 0xff);
+	param_buf[5] = (uint8_t)(arg_addr & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 6);
+	arg_params->is_prog_data = true;
+
+	// A byte takes up to the maximum pulses, and when it verifies the margin pulse is as long again
+	arg_serial_com->set_timeout(arg_params->timeoutms + 2 * arg_params->pulse_max * arg_params->pulse_width / 10);
+	for(i = 0; i < arg_len; i++){
+		tx_chunk(arg_params, arg_serial_com, arg_txbuf + i, 1);
+		rx_chunk(arg_params, arg_serial_com, rxbyte, 2);
+		arg_rxbuf[i] = rxbyte[0];
+		arg_pulsebuf[i] = rxbyte[1];
+	}
+	arg_serial_com->set_timeout(arg_params->timeoutms);
+	arg_params->is_prog_data = false;
+}
+
+// The bootloader's baud rate for the crystal, arg_baud is the rate with an 8MHz crystal
+uint32_t get_boot_baud(cl_my_params *arg_params, uint32_t arg_baud){
+	return (uint32_t)((uint64_t)arg_baud * arg_params->xtal_hz / XTAL_DEFAULT_HZ);
+}
+
+// The SCI BAUD register value for the fastest standard baud rate the crystal can make within BAUD_MAX_ERROR_PERCENT,
+// the baud rate is returned in arg_baud
+// SCI baud rate = E clock (crystal / 4) / 16 / prescaler (SCP bits 5-4) / 2^SCR (bits 2-0)
+uint8_t get_talker_baud_reg(cl_my_params *arg_params, uint32_t *arg_baud){
+	static const uint32_t std_bauds[] = { 115200, 57600, 38400, 19200, 9600, 4800, 2400, 1200 };
+	static const uint32_t prescalers[] = { 1, 3, 4, 13 };
+	uint32_t i;
+	uint32_t scp;
+	uint32_t scr;
+	uint32_t rate;
+
+	for(i = 0; i < sizeof(std_bauds) / sizeof(std_bauds[0]); i++){
+		if(arg_params->max_baud && std_bauds[i] > arg_params->max_baud){
+			continue;
+		}
+		for(scp = 0; scp < sizeof(prescalers) / sizeof(prescalers[0]); scp++){
+			for(scr = 0; scr < 8; scr++){
+				rate = arg_params->xtal_hz / ((64 * prescalers[scp]) << scr);
+				if(((rate > std_bauds[i]) ? rate - std_bauds[i] : std_bauds[i] - rate) * 100 <= std_bauds[i] * BAUD_MAX_ERROR_PERCENT){
+					*arg_baud = std_bauds[i];
+					return (uint8_t)(scp << 4 | scr);
+				}
+			}
+		}
+	}
+
+	// No standard baud rate is close enough, keep the default BAUD register value
+	*arg_baud = arg_params->xtal_hz / (64 * 13);
+	return HC11_BAUD_DEFAULT;
+}
+
+uint32_t get_talker_baud(cl_my_params *arg_params){
+	uint32_t baud;
+
+	get_talker_baud_reg(arg_params, &baud);
+
+	return baud;
+}
+
+// Set the serial COM port for the talker, in multi-drop the ninth bit of the bytes to the talkers is sent as space parity
+void set_talker_port(cl_my_params *arg_params, serial_com *arg_serial_com){
+	arg_serial_com->set_params(get_talker_baud(arg_params), 8, arg_params->units.empty() ? NOPARITY : SPACEPARITY, ONESTOPBIT, false);
+}
+
+// After a link error with at least line_errors= receive line errors since arg_error_mark, lower the talker baud rate to
+// the next standard rate down.  The talker's BAUD register is written with the write command, its echo is sent at the
+// new rate so it is discarded and the talker pinged instead.  Returns true when the talker replied at the lower rate,
+// the failed transfer may then be resumed
+bool fallback_baud(cl_my_params *arg_params, serial_com *arg_serial_com, tru_exception *arg_ex, uint32_t arg_error_mark){
+	uint32_t error_count = line_error_count(arg_serial_com) - arg_error_mark;
+	uint32_t baud = get_talker_baud(arg_params);
+	uint32_t max_baud = arg_params->max_baud;
+	uint32_t new_baud;
+	uint8_t baud_reg;
+	uint8_t param_buf[3];
+	uint8_t rxbyte;
+
+	if(arg_params->line_error_limit == 0 || error_count < arg_params->line_error_limit || !arg_params->units.empty()){
+		return false;
+	}
+
+	arg_params->max_baud = baud - 1;
+	baud_reg = get_talker_baud_reg(arg_params, &new_baud);
+	if(new_baud >= baud){
+		arg_params->max_baud = max_baud;  // Already the slowest
+		return false;
+	}
+
+	*arg_params->out << std::endl << "Link error: " << arg_ex->get_message() << ", " << error_count << " line error(s)" << std::endl;
+	*arg_params->out << "Lowering the talker baud rate from " << baud << " to " << new_baud << std::endl;
+	try{
+		// No fillers when the failed transfer may have left a programming command in its data loop
+		resync_talker(arg_params, arg_serial_com, !arg_params->is_prog_data);
+
+		param_buf[0] = TALKER_WRITE_CMD;
+		txrx_chunk(arg_params, arg_serial_com, param_buf, &rxbyte, 1, true);
+		param_buf[0] = 1;
+		param_buf[1] = (uint8_t)(HC11_BAUD_ADDR >> 8 & 0xff);
+		param_buf[2] = (uint8_t)(HC11_BAUD_ADDR & 0xff);
+		tx_chunk(arg_params, arg_serial_com, param_buf, 3);
+		tx_chunk(arg_params, arg_serial_com, &baud_reg, 1);
+
+		// Wait out the echo at the new rate
+#if defined(WIN32) || defined(WIN64)
+		Sleep(20 * 1000 / new_baud + 1);
+#else
+		usleep(20 * 1000000 / new_baud);
+#endif
+		arg_serial_com->set_params(new_baud, 8, NOPARITY, ONESTOPBIT, false);
+		arg_serial_com->purge();
+	}catch(tru_exception &ex){
+		(void)ex;  // Suppress unreferenced warning, the caller throws the first error
+		arg_params->max_baud = max_baud;
+		return false;
+	}
+
+	return ping_talker(arg_params, arg_serial_com);
+}
+
+// Patch the timing parameters of a talker or loader image for the crystal and baud=, see the talker and loader for the
+// addresses.  The images are assembled for an 8MHz crystal at the default BAUD register value, so with both nothing is
+// patched, and with only baud= lowering the rate just the BAUD register value is
+void patch_control_program(cl_my_params *arg_params, uint8_t *arg_buf, uint32_t arg_len, uint16_t arg_addr, bool arg_is_loader){
+	uint32_t baud;
+	uint8_t baud_reg = get_talker_baud_reg(arg_params, &baud);
+	bool is_xtal = arg_params->xtal_hz != XTAL_DEFAULT_HZ;
+	uint32_t delay_cnt = (arg_params->xtal_hz + 2399) / 2400;  // E clock cycles in 10ms / 6, rounded up
+	uint32_t pulse_cycles = (arg_params->xtal_hz + 39999) / 40000;  // E clock cycles in 0.1ms, rounded up
+	uint32_t pulse_cnt = (pulse_cycles > 8) ? (pulse_cycles - 8 + 4) / 5 : 1;
+
+	if(!is_xtal && baud_reg == HC11_BAUD_DEFAULT){
+		return;
+	}
+	// Unpatched, the talker would come up at a rate the host port is not set to and no command would get through
+	if(arg_addr != 0 || arg_len <= TALKER_PULSE_CNT_ADDR){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TALKER_PATCH_ID, std::format(app_error_string::messages[APP_ERROR_TALKER_PATCH_ID], arg_addr, arg_len, baud), "");
+	}
+
+	if(arg_is_loader){
+		arg_buf[LOADER_BAUD_VAL_ADDR] = baud_reg;
+	}else{
+		if(is_xtal){
+			delay_cnt = (delay_cnt > 0xffff) ? 0xffff : delay_cnt;
+			pulse_cnt = (pulse_cnt > 0xff) ? 0xff : pulse_cnt;
+			arg_buf[TALKER_DELAY_CNT_ADDR] = (uint8_t)(delay_cnt >> 8 & 0xff);
+			arg_buf[TALKER_DELAY_CNT_ADDR + 1] = (uint8_t)(delay_cnt & 0xff);
+			if(arg_params->ram_size > BOOTLOADER_MAX_BYTE_COUNT){
+				arg_buf[TALKER_PULSE_CNT_ADDR] = (uint8_t)pulse_cnt;
+			}
+			*arg_params->out << "Talker timing for a " << arg_params->xtal_hz << "Hz crystal: " << baud << " baud, 10ms delay count " << delay_cnt << std::endl;
+		}else{
+			*arg_params->out << "Talker at " << baud << " baud" << std::endl;
+		}
+		arg_buf[TALKER_BAUD_VAL_ADDR] = baud_reg;
+	}
+}
+
+// Read a control program (talker or loader) S-record file into a buffer, the S1 records must be contiguous
+// Returns the byte count, and the address of the first S1 record
+uint32_t read_control_program(cl_my_params *arg_params, std::string arg_file_name, uint8_t *arg_buf, uint32_t arg_max_len, uint16_t *arg_addr){
+	cl_my_file talker_file;
+	std::string line_str;
+	uint8_t srec_bytecount;
+	uint32_t byte_index = 0;
+	uint16_t data_index;
+
+	*arg_params->out << "Loading " << arg_file_name << std::endl;
+	talker_file.open_file(arg_file_name, "rb");
+
+	do{
+		talker_file.read_file_line(line_str);
+
+		//std::cout << "Line: " << line_str << std::endl;
+
+		// Check for valid S1 record
+		if(line_str.size() > 8){
+			// S1 record type?
+			if(line_str.compare(0, 2, "S1") == 0){
+				srec_bytecount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16);  // Extract srecord data byte count
+				// Byte count is valid?
+				if((srec_bytecount > 0) && (srec_bytecount >= ((line_str.size() - 4) / 2))){
+					if(srec_bytecount > SREC_ADDR_CHECKSUM_COUNT){
+						*arg_params->out << line_str << std::endl;
+						if(byte_index == 0){
+							*arg_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);  // Extract srecord address
+						}
+
+						// Loop through record data (exclude the 16 bit address and 8 bit checksum)
+						for(data_index = 0; data_index < (uint8_t)(srec_bytecount - SREC_ADDR_CHECKSUM_COUNT); data_index++){
+							// Not more than the maximum size?
+							if(byte_index == arg_max_len){
+								throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TALKER_TOO_BIG_ID, std::format(app_error_string::messages[APP_ERROR_TALKER_TOO_BIG_ID], arg_max_len), "");
+							}
+
+							arg_buf[byte_index] = (uint8_t)strtoul(line_str.substr(2 * data_index + 8, 2).c_str(), NULL, 16);
+							byte_index++;
+						}
+					}
+				}
+			}
+		}
+	}while(!talker_file.eof());
+
+	return byte_index;
+}
+
+// Returns the count of talker bytes the loader loads, the rest overlapping the loader's load loop at the top of
+// internal RAM is written by the talker itself.  Throws when the talker does not fit
+uint32_t get_stage2_load_len(cl_my_params *arg_params, uint16_t arg_addr, uint32_t arg_byte_count){
+	uint32_t max_len;
+	uint32_t load_len;
+
+	// Internal RAM or external memory?
+	if(arg_addr < arg_params->ram_size){
+		max_len = arg_params->ram_size - arg_addr;
+		load_len = ((uint32_t)arg_addr + LOADER_RESERVED_BYTE_COUNT < arg_params->ram_size) ? arg_params->ram_size - LOADER_RESERVED_BYTE_COUNT - arg_addr : 0;
+	}else{
+		max_len = LOADER_MAX_BYTE_COUNT - arg_addr;
+		load_len = max_len;
+	}
+	if(arg_byte_count > max_len || load_len == 0){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_TALKER_TOO_BIG_ID, std::format(app_error_string::messages[APP_ERROR_TALKER_TOO_BIG_ID], max_len), "");
+	}
+
+	return (load_len > arg_byte_count) ? arg_byte_count : load_len;
+}
+
+// Note: all MCU types have minimum of 256 bytes RAM (some have more)
+// The A and 811E2 bootloaders always receive 256 bytes, so for 256 bytes RAM the talker is padded.
+// The E series bootloaders receive up to the RAM size and jump to it early when the serial line goes idle, so for more
+// than 256 bytes RAM only the talker bytes are sent
+// For a two-stage boot the loader is sent instead of the talker, see send_talker_stage2()
+void send_control_program(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint32_t byte_index;
+	uint32_t pad_index;
+	uint16_t addr;
+	uint8_t txbyte;
+	cl_my_buf txbuf;
+	cl_my_buf rxbuf;
+	uint8_t *txbuf_p;
+	uint8_t *rxbuf_p;
+	uint32_t len;
+
+	if(arg_params->ram_size != 256 && arg_params->ram_size != 512 && arg_params->ram_size != 768 && arg_params->ram_size != 1024){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_RAM_SIZE_ID, std::format(app_error_string::messages[APP_ERROR_RAM_SIZE_ID], arg_params->ram_size), "");
+	}
+
+	// Two-stage boot, check the talker fits below the loader's reserved RAM now, once the loader is sent only a reset
+	// gets back to the bootloader
+	if(arg_params->loader_filename.size() > 0){
+		txbuf.alloc_buf(LOADER_MAX_BYTE_COUNT);
+		byte_index = read_control_program(arg_params, arg_params->talker_filename, txbuf.get_buf(), LOADER_MAX_BYTE_COUNT, &addr);
+		get_stage2_load_len(arg_params, addr, byte_index);
+	}
+
+	len = (arg_params->serial_txbuf_size > arg_params->ram_size) ? arg_params->serial_txbuf_size : arg_params->ram_size;
+	txbuf.alloc_buf(len);
+	txbuf_p = txbuf.get_buf();
+
+	len = (arg_params->serial_rxbuf_size > arg_params->ram_size) ? arg_params->serial_rxbuf_size : arg_params->ram_size;
+	rxbuf.alloc_buf(len);
+	rxbuf_p = rxbuf.get_buf();
+
+	// =====================
+	// Read file into buffer
+	// =====================
+
+	byte_index = read_control_program(arg_params, (arg_params->loader_filename.size() > 0) ? arg_params->loader_filename : arg_params->talker_filename, txbuf_p, arg_params->ram_size, &addr);
+	patch_control_program(arg_params, txbuf_p, byte_index, addr, arg_params->loader_filename.size() > 0);
+
+	// If control program is small, pad with 0x00 bytes for bootloaders that always receive 256 bytes
+	if(arg_params->ram_size == BOOTLOADER_MAX_BYTE_COUNT){
+		for(pad_index = byte_index; pad_index < BOOTLOADER_MAX_BYTE_COUNT; pad_index++){
+			txbuf_p[byte_index] = 0x00;
+			byte_index++;
+		}
+	}
+
+	// ========
+	// Download
+	// ========
+
+	// Transmit leading 0xff byte and no echo expected
+	*arg_params->out << "Transmitting sync char 0xff" << std::endl;
+	txbyte = 0xff;
+	tx_chunk(arg_params, arg_serial_com, &txbyte, 1);
+
+	// Transmit talker bytes
+	*arg_params->out << "Transmitting talker bytes" << std::endl;
+	txbuf_p = txbuf.get_buf();
+	txrx_chunk_control_program(arg_params, arg_serial_com, txbuf_p, rxbuf_p, byte_index);
+}
+
+// Two-stage boot: send the talker to the loader (stage 1) already running on the MCU, see the loader for the protocol
+// The loader keeps its load loop at the top of internal RAM, so the part of the talker overlapping it is written by
+// the talker itself once it is running
+void send_talker_stage2(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint32_t byte_count;
+	uint16_t addr;
+	uint32_t load_len;
+	uint8_t param_buf[4];
+	cl_my_buf txbuf;
+	cl_my_buf rxbuf;
+
+	txbuf.alloc_buf(LOADER_MAX_BYTE_COUNT);
+	rxbuf.alloc_buf(LOADER_MAX_BYTE_COUNT);
+
+	byte_count = read_control_program(arg_params, arg_params->talker_filename, txbuf.get_buf(), LOADER_MAX_BYTE_COUNT, &addr);
+	patch_control_program(arg_params, txbuf.get_buf(), byte_count, addr, false);
+	load_len = get_stage2_load_len(arg_params, addr, byte_count);
+
+	// Transmit start and end load address, low byte first
+	param_buf[0] = (uint8_t)(addr & 0xff);
+	param_buf[1] = (uint8_t)(addr >> 8 & 0xff);
+	param_buf[2] = (uint8_t)((addr + load_len) & 0xff);
+	param_buf[3] = (uint8_t)((addr + load_len) >> 8 & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 4);
+
+	// Transmit talker bytes, the loader replies with each byte reread
+	*arg_params->out << "Transmitting talker bytes to loader" << std::endl;
+	txrx_chunk(arg_params, arg_serial_com, txbuf.get_buf(), rxbuf.get_buf(), load_len, true);
+
+	// Write the rest over the load loop with the talker's write command, which replies with each byte reread
+	if(byte_count > load_len){
+		wait_talker_ready(arg_params, arg_serial_com);
+		*arg_params->out << "Transmitting the last " << byte_count - load_len << " talker bytes to the talker" << std::endl;
+		param_buf[0] = TALKER_WRITE_CMD;
+		txrx_chunk(arg_params, arg_serial_com, param_buf, rxbuf.get_buf(), 1, true);
+		param_buf[0] = (uint8_t)(byte_count - load_len);
+		param_buf[1] = (uint8_t)((addr + load_len) >> 8 & 0xff);
+		param_buf[2] = (uint8_t)((addr + load_len) & 0xff);
+		tx_chunk(arg_params, arg_serial_com, param_buf, 3);
+		txrx_chunk(arg_params, arg_serial_com, txbuf.get_buf() + load_len, rxbuf.get_buf(), byte_count - load_len, true);
+	}
+}
+
+// Read a byte of memory
+uint8_t talker_read_byte(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr){
+	uint8_t rxbyte;
+
+	readmem_chunk(arg_params, arg_serial_com, arg_addr, &rxbyte, 1);
+
+	return rxbyte;
+}
+
+// Write a byte of normal memory, returns the byte reread
+uint8_t talker_write_byte(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t arg_value){
+	uint8_t param_buf[3];
+	uint8_t rxbyte;
+
+	param_buf[0] = TALKER_WRITE_CMD;
+	txrx_chunk(arg_params, arg_serial_com, param_buf, &rxbyte, 1, true);
+	param_buf[0] = 1;
+	param_buf[1] = (uint8_t)(arg_addr >> 8 & 0xff);
+	param_buf[2] = (uint8_t)(arg_addr & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 3);
+	txrx_chunk_write(arg_params, arg_serial_com, &arg_value, &rxbyte, 1, false);
+
+	return rxbyte;
+}
+
+// Probe for internal RAM at an address, the original values are restored
+// In special test mode an unmapped address is on the external bus, and a floating data bus may read back the last
+// value written, so a second (decoy) address is written with a different value before reading back
+bool probe_ram(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr){
+	uint16_t decoy_addr = arg_addr + MCU_PROBE_DECOY_OFS;
+	uint8_t value = talker_read_byte(arg_params, arg_serial_com, arg_addr);
+	uint8_t decoy_value = talker_read_byte(arg_params, arg_serial_com, decoy_addr);
+	bool is_ram;
+
+	talker_write_byte(arg_params, arg_serial_com, arg_addr, (uint8_t)~value);
+	talker_write_byte(arg_params, arg_serial_com, decoy_addr, value);
+	is_ram = talker_read_byte(arg_params, arg_serial_com, arg_addr) == (uint8_t)~value;
+	talker_write_byte(arg_params, arg_serial_com, arg_addr, value);
+	talker_write_byte(arg_params, arg_serial_com, decoy_addr, decoy_value);
+
+	return is_ram;
+}
+
+// Probe for a writable register bit, the original value is restored.  Reserved register bits always read 0
+bool probe_reg_bit(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t arg_mask){
+	uint8_t value = talker_read_byte(arg_params, arg_serial_com, arg_addr);
+	bool is_present;
+
+	is_present = talker_write_byte(arg_params, arg_serial_com, arg_addr, value | arg_mask) & arg_mask;
+	talker_write_byte(arg_params, arg_serial_com, arg_addr, value);
+
+	return is_present;
+}
+
+// Detect the MCU variant with the talker running and select its profile:
+// RAM size: probe the top half of each RAM size (the talker and its stack are at the bottom and the top)
+// 1024: F1
+// 768:  711E20 if the EPROG register ELAT bit is present, else E20
+// 512:  711E9 if the PPROG register ELAT bit is present, else E9 if CONFIG ROMON is set, else E1
+// 256:  811E2 if the CONFIG EEPROM block select bits (EE3-EE0) are present, else A1
+// Note, external memory at the RAM probe addresses is taken as RAM
+void detect_mcu(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint32_t ram_size = 256;
+	uint8_t config;
+
+	set_talker_port(arg_params, arg_serial_com);
+
+	while(ram_size < 1024 && probe_ram(arg_params, arg_serial_com, (uint16_t)(ram_size + MCU_PROBE_RAM_OFS))){
+		ram_size += 256;
+	}
+	config = talker_read_byte(arg_params, arg_serial_com, HC11_CONFIG_ADDR);
+
+	switch(ram_size){
+		case 1024:
+			arg_params->mcu_name = "F1";
+			break;
+		case 768:
+			arg_params->mcu_name = probe_reg_bit(arg_params, arg_serial_com, HC11_EPROG_ADDR, HC11_ELAT_BIT) ? "711E20" : "E20";
+			break;
+		case 512:
+			if(probe_reg_bit(arg_params, arg_serial_com, HC11_PPROG_ADDR, HC11_ELAT_BIT)){
+				arg_params->mcu_name = "711E9";
+			}else{
+				arg_params->mcu_name = (config & HC11_CONFIG_ROMON_BIT) ? "E9" : "E1";
+			}
+			break;
+		default:
+			arg_params->mcu_name = (config & HC11_CONFIG_EE_BITS) ? "811E2" : "A1";
+			break;
+	}
+
+	*arg_params->out << "Detected MC68HC" << ((arg_params->mcu_name[0] == 'E' || arg_params->mcu_name[0] == 'A' || arg_params->mcu_name[0] == 'F') ? "11" : "") << arg_params->mcu_name << ": " << ram_size << " bytes RAM, CONFIG " << string_utils_ns::to_string_right_hex_up((uint16_t)config, 2, '0') << std::endl;
+	if(arg_params->mcu_name == "811E2" && (config & HC11_CONFIG_EE_BITS) != HC11_CONFIG_EE_BITS){
+		*arg_params->out << "Note, the EEPROM is at " << string_utils_ns::to_string_right_hex_up((uint16_t)((config & HC11_CONFIG_EE_BITS) << 8 | 0x0800), 4, '0') << ", the profile assumes F800" << std::endl;
+	}
+}
+
+// Length of the next talker chunk from an address, limited by the region of the MCU profile (if any)
+uint32_t get_chunk_len(const mcu_profile *arg_profile, uint16_t arg_addr, uint32_t arg_remaining){
+	uint32_t chunklen = (arg_remaining > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : arg_remaining;
+	const mcu_region *region;
+	uint8_t i;
+
+	if(arg_profile != NULL){
+		region = mcu_profile_find_region(arg_profile, arg_addr);
+		if(region != NULL){
+			// Stay within the region
+			if(chunklen > region->max_chunk_len){
+				chunklen = region->max_chunk_len;
+			}
+			if(chunklen > (uint32_t)region->end_addr - arg_addr + 1){
+				chunklen = (uint32_t)region->end_addr - arg_addr + 1;
+			}
+		}else{
+			// Unmapped (external memory), stop before the next region
+			for(i = 0; i < arg_profile->region_count; i++){
+				if(arg_profile->regions[i].start_addr > arg_addr && chunklen > (uint32_t)arg_profile->regions[i].start_addr - arg_addr){
+					chunklen = (uint32_t)arg_profile->regions[i].start_addr - arg_addr;
+				}
+			}
+		}
+	}
+
+	return chunklen;
+}
+
+// Read the checksums of consecutive blocks with the talker checksum command, see the talker for the protocol
+void readmem_sums(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint32_t arg_block_count, uint32_t arg_block_len, uint16_t *arg_sums){
+	uint8_t param_buf[4];
+	uint8_t rxbuf[2 * TALKER_MAX_BYTE_COUNT];
+
+	// Transmit command
+	param_buf[0] = TALKER_SUM_CMD;
+	txrx_chunk(arg_params, arg_serial_com, param_buf, rxbuf, 1, true);
+
+	// Transmit parameters
+	param_buf[0] = (uint8_t)arg_block_count;
+	param_buf[1] = (uint8_t)arg_block_len;
+	param_buf[2] = (uint8_t)(arg_addr >> 8 & 0xff);
+	param_buf[3] = (uint8_t)(arg_addr & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 4);
+
+	rx_chunk(arg_params, arg_serial_com, rxbuf, 2 * arg_block_count);
+	for(uint32_t i = 0; i < arg_block_count; i++){
+		arg_sums[i] = (uint16_t)(rxbuf[2 * i] << 8 | rxbuf[2 * i + 1]);
+	}
+}
+
+// Read a chunk of memory for read sync=y.  The chunk is taken from the previous read when its checksum matches,
+// else the checksums of its sub-blocks are compared and only the sub-blocks that do not match are read
+void sync_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, sync_image *arg_image, uint16_t arg_addr, uint8_t *arg_rxbuf, uint32_t arg_len){
+	const int16_t *old_p = &arg_image->bytes[arg_addr];  // Copied to the receive buffer, then read over where it changed
+	uint16_t sums[TALKER_MAX_BYTE_COUNT / SYNC_SUB_BLOCK_LEN];
+	uint32_t sub_count = arg_len / SYNC_SUB_BLOCK_LEN;  // A shorter last sub-block is always read
+	uint32_t sub_ofs;
+	uint32_t sub_len;
+	uint32_t i;
+
+	arg_image->byte_count += arg_len;
+
+	// Not all in the previous read?
+	for(i = 0; i < arg_len; i++){
+		if(old_p[i] < 0){
+			readmem_chunk(arg_params, arg_serial_com, arg_addr, arg_rxbuf, arg_len);
+			arg_image->fetched_count += arg_len;
+			arg_image->rx_count += 1 + arg_len;
+			return;
+		}
+		arg_rxbuf[i] = (uint8_t)old_p[i];
+	}
+
+	readmem_sums(arg_params, arg_serial_com, arg_addr, 1, arg_len, sums);
+	arg_image->rx_count += 3;
+	if(sums[0] == talker_checksum(arg_rxbuf, arg_len)){
+		return;
+	}
+
+	if(sub_count > 0){
+		readmem_sums(arg_params, arg_serial_com, arg_addr, sub_count, SYNC_SUB_BLOCK_LEN, sums);
+		arg_image->rx_count += 1 + 2 * sub_count;
+	}
+	for(sub_ofs = 0, i = 0; sub_ofs < arg_len; sub_ofs += SYNC_SUB_BLOCK_LEN, i++){
+		sub_len = (arg_len - sub_ofs > SYNC_SUB_BLOCK_LEN) ? SYNC_SUB_BLOCK_LEN : arg_len - sub_ofs;
+		if(i == sub_count || sums[i] != talker_checksum(arg_rxbuf + sub_ofs, sub_len)){
+			readmem_chunk(arg_params, arg_serial_com, (uint16_t)(arg_addr + sub_ofs), arg_rxbuf + sub_ofs, sub_len);
+			arg_image->fetched_count += sub_len;
+			arg_image->rx_count += 1 + sub_len;
+		}
+	}
+}
+
+// Load the previous read for read sync=y, a missing file leaves every byte to be read
+void load_sync_image(cl_my_params *arg_params, sync_image *arg_image){
+	cl_my_file in_file;
+	std::string line_str;
+	uint16_t srec_addr;
+	uint8_t srec_datacount;
+	uint8_t i;
+
+	arg_image->bytes.assign(0x10000, -1);
+	arg_image->byte_count = 0;
+	arg_image->fetched_count = 0;
+	arg_image->rx_count = 0;
+
+	try{
+		in_file.open_file(arg_params->full_file_name, "rb");
+	}catch(tru_exception &ex){
+		(void)ex;  // Suppress unreferenced warning, no previous read
+		*arg_params->out << "No previous read in " << arg_params->full_file_name << ", reading all" << std::endl;
+		return;
+	}
+
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
+			srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+			for(i = 0; i < srec_datacount && line_str.size() >= 2 * (size_t)i + 10; i++){
+				arg_image->bytes[(uint16_t)(srec_addr + i)] = (int16_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
+			}
+		}
+	}while(!in_file.eof());
+}
+
+// Read a range of memory, show it and append it as S1 records to the file (if open)
+// With a previous read (sync=y) only the blocks that changed are read
+void readmem_range(cl_my_params *arg_params, serial_com *arg_serial_com, cl_my_file *arg_out_file, sync_image *arg_image, uint16_t arg_from_addr, uint16_t arg_to_addr){
+	uint32_t i;
+	uint16_t addr;
+	size_t bytes_written;
+	std::string srec_line;
+	std::string srec_addr_str;
+	uint8_t datacount = 0;
+	uint8_t srec_bytecount = SREC_ADDR_CHECKSUM_COUNT + arg_params->srec_datalen;
+	uint8_t checksum = 0;
+	cl_my_buf rxbuf;
+	uint8_t *rxbuf_p;
+	uint32_t chunklen = 0;
+	uint32_t remaining;
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+
+	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
+	rxbuf_p = rxbuf.get_buf();
+
+	checksum += (arg_from_addr >> 8) & 0xff;
+	checksum += arg_from_addr & 0xff;
+	srec_addr_str = string_utils_ns::to_string_right_hex_up(arg_from_addr, 4, '0');
+	remaining = (uint32_t)arg_to_addr - arg_from_addr + 1;
+	addr = arg_from_addr;
+
+	while(remaining){
+		chunklen = get_chunk_len(profile, addr, remaining);
+
+		rxbuf_p = rxbuf.get_buf();
+		if(arg_image != NULL){
+			sync_chunk(arg_params, arg_serial_com, arg_image, addr, rxbuf_p, chunklen);
+		}else{
+			readmem_chunk(arg_params, arg_serial_com, addr, rxbuf_p, chunklen);
+		}
+		if(arg_params->read_buf != NULL){
+			arg_params->read_buf->insert(arg_params->read_buf->end(), rxbuf_p, rxbuf_p + chunklen);
+		}
+
+		remaining -= chunklen;
+		report_progress(arg_params, (uint32_t)arg_to_addr - arg_from_addr + 1 - remaining, (uint32_t)arg_to_addr - arg_from_addr + 1);
+
+		for(i = 0; i < chunklen; i++){
+			if(datacount == 0){
+				*arg_params->out << string_utils_ns::to_string_right_hex_up(addr, 4, '0') << ":";
+			}
+
+			*arg_params->out << string_utils_ns::to_string_right_hex_up((uint16_t)*rxbuf_p, 2, '0');
+
+			srec_line += string_utils_ns::to_string_right_hex_up((uint16_t)*rxbuf_p, 2, '0');
+			datacount++;
+			checksum += *rxbuf_p;
+
+			// One line per S1 record, also when there is no file
+			if(datacount == (srec_bytecount - SREC_ADDR_CHECKSUM_COUNT)){
+				if(arg_out_file != NULL){
+					checksum += datacount + SREC_ADDR_CHECKSUM_COUNT;
+					checksum = ~checksum;
+
+					// Create S1 record: S1 + length + checksum
+					srec_line =
+						"S1" +
+						string_utils_ns::to_string_right_hex_up((uint16_t)(datacount + SREC_ADDR_CHECKSUM_COUNT), 2, '0') +
+						srec_addr_str +
+						srec_line + string_utils_ns::to_string_right_hex_up((uint16_t)checksum, 2, '0') +
+						"\r\n";
+
+					// Write Motorola file format header S1 record
+					arg_out_file->write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+				}
+
+				datacount = 0;
+				checksum = 0;
+				checksum += ((addr + 1) >> 8) & 0xff;
+				checksum += (addr + 1) & 0xff;
+				srec_line.clear();
+				srec_addr_str = string_utils_ns::to_string_right_hex_up((uint16_t)(addr + 1), 4, '0');
+
+				*arg_params->out << std::endl;
+			}
+
+			rxbuf_p++;
+			addr++;
+		}
+	}
+
+	// Do we have remaining bytes?
+	if(datacount > 0){
+		if(arg_out_file != NULL){
+			checksum += datacount + SREC_ADDR_CHECKSUM_COUNT;
+			checksum = ~checksum;
+
+			// Create S1 record: S1 + length + checksum
+			srec_line =
+				"S1" +
+				string_utils_ns::to_string_right_hex_up((uint16_t)(datacount + SREC_ADDR_CHECKSUM_COUNT), 2, '0') +
+				srec_addr_str +
+				srec_line + string_utils_ns::to_string_right_hex_up((uint16_t)checksum, 2, '0') +
+				"\r\n";
+
+			// Write Motorola file format header S1 record
+			arg_out_file->write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+		}
+
+		*arg_params->out << std::endl;
+	}
+}
+
+// Read memory, either the from_addr to to_addr range or with all=y every mapped region of the MCU profile
+void readmem(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint8_t i;
+	cl_my_file out_file;
+	cl_my_file *out_file_p = NULL;
+	size_t bytes_written;
+	std::string srec_line;
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	sync_image image;
+	sync_image *image_p = NULL;
+
+	if(arg_params->use_all && profile == NULL){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MCU_NEEDED_ID, app_error_string::messages[APP_ERROR_MCU_NEEDED_ID], "all=y");
+	}
+
+	// Load the previous read before the file is overwritten
+	if(arg_params->use_sync){
+		if(arg_params->full_file_name.size() == 0 || arg_params->ram_size <= 256){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_SYNC_ID, app_error_string::messages[APP_ERROR_SYNC_ID], "");
+		}
+		load_sync_image(arg_params, &image);
+		image_p = &image;
+	}
+
+	if(arg_params->full_file_name.size() > 0){
+		out_file.open_file(arg_params->full_file_name, "wb");
+		out_file_p = &out_file;
+
+		// Write Motorola file format header S0 record
+		srec_line = "S0030000FC\r\n";
+		out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+	}
+
+	if(arg_params->use_all){
+		// Skip the unmapped holes
+		for(i = 0; i < profile->region_count; i++){
+			if(profile->regions[i].is_read_all){
+				*arg_params->out << "Reading " << mcu_mem_type_str(profile->regions[i].type) << " " << string_utils_ns::to_string_right_hex_up(profile->regions[i].start_addr, 4, '0') << "-" << string_utils_ns::to_string_right_hex_up(profile->regions[i].end_addr, 4, '0') << std::endl;
+				readmem_range(arg_params, arg_serial_com, out_file_p, image_p, profile->regions[i].start_addr, profile->regions[i].end_addr);
+			}
+		}
+	}else{
+		readmem_range(arg_params, arg_serial_com, out_file_p, image_p, (uint16_t)arg_params->from_addr, (uint16_t)arg_params->to_addr);
+	}
+
+	if(out_file_p != NULL){
+		// Create footer S9 record
+		srec_line = "S9030000FC\r\n";
+
+		// Write Motorola file format termination S9 record
+		out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+	}
+
+	if(image_p != NULL){
+		*arg_params->out << std::endl << "Sync read " << image.fetched_count << " of " << image.byte_count << " bytes, " << image.rx_count << " bytes received" << std::endl;
+	}
+
+	*arg_params->out << std::endl << "Read successfully completed" << std::endl;
+}
+
+// Returns true when all bytes matched
+bool readmem_verify(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint32_t i;
+	cl_my_file in_file;
+	std::string line_str;
+	std::string ic_line_str;
+	uint16_t srec_addr;
+	uint8_t srec_datacount;
+	uint32_t total_databytes = 0;
+	uint8_t file_byte;
+	cl_my_buf rxbuf;
+	uint8_t *rxbuf_p;
+	uint32_t line_mismatch_count;
+	uint32_t mismatch_count = 0;
+	uint32_t line_ignore_count;
+	uint32_t ignore_count = 0;
+	uint32_t file_databytes = arg_params->on_progress ? get_srec_data_count(arg_params->full_file_name) : 0;  // Total for the progress hook
+
+	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
+	rxbuf_p = rxbuf.get_buf();
+
+	in_file.open_file(arg_params->full_file_name, "rb");
+
+	do{
+		// Read line from file
+		in_file.read_file_line(line_str);
+
+		// Record string length must be atleast the minimum of 8
+		if(line_str.size() >= 8){
+			// We only want S1 records
+			if(line_str.substr(0, 2) == "S1"){
+				*arg_params->out << "File: " << line_str << std::endl;
+				srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
+				srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;  // Extract srecord data byte count
+
+				ic_line_str.clear();
+				line_mismatch_count = 0;
+				line_ignore_count = 0;
+				rxbuf_p = rxbuf.get_buf();
+
+				// Read a chunk of memory
+				readmem_chunk(arg_params, arg_serial_com, srec_addr, rxbuf_p, srec_datacount);
+
+				// Loop each data byte
+				for(i = 0; i < srec_datacount; i++){
+					if(!arg_params->verify_config && srec_addr == HC11_CONFIG_ADDR){
+						line_ignore_count++;
+						ignore_count++;
+					}else{
+						file_byte = (uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
+						if(*rxbuf_p != file_byte){
+							line_mismatch_count++;
+							mismatch_count++;
+							if(arg_params->mismatches != NULL){
+								arg_params->mismatches->push_back({ srec_addr, file_byte, *rxbuf_p });
+							}
+						}
+					}
+
+					ic_line_str += string_utils_ns::to_string_right_hex_up((uint16_t)*rxbuf_p, 2, '0');
+
+					srec_addr++;
+					rxbuf_p++;
+				}
+
+				if(line_mismatch_count && line_ignore_count){
+					*arg_params->out << "Rx  :         " << ic_line_str << " = " << line_mismatch_count << " mismatched, " << line_ignore_count << " ignored" << std::endl;
+				}else if(line_mismatch_count){
+					*arg_params->out << "Rx  :         " << ic_line_str << " = " << line_mismatch_count << " mismatched" << std::endl;
+				}else if(line_ignore_count == srec_datacount){
+					*arg_params->out << "Rx  :         " << ic_line_str << " = " << line_ignore_count << " ignored" << std::endl;
+				}else if(line_ignore_count){
+					*arg_params->out << "Rx  :         " << ic_line_str << " = " << (uint16_t)srec_datacount << " matched, " << line_ignore_count << " ignored" << std::endl;
+				}else{
+					*arg_params->out << "Rx  :         " << ic_line_str << " = " << (uint16_t)srec_datacount << " matched" << std::endl;
+				}
+
+				total_databytes += srec_datacount;
+				report_progress(arg_params, total_databytes, file_databytes);
+			}
+		}
+	}while(!in_file.eof());
+
+	if(mismatch_count){
+		if(ignore_count){
+			*arg_params->out << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched, " << ignore_count << " ignored" << std::endl;
+		}else{
+			*arg_params->out << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched" << std::endl;
+		}
+	}else{
+		if(ignore_count){
+			*arg_params->out << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched, " << ignore_count <<  " ignored" << std::endl;
+		}else{
+			*arg_params->out << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched" << std::endl;
+		}
+	}
+
+	return mismatch_count == 0;
+}
+
+// The talker call command is assembled for RamSize > 512 without MultiDrop
+bool is_call_talker(cl_my_params *arg_params){
+	return arg_params->ram_size > 512 && arg_params->units.empty();
+}
+
+// Call a routine in the MCU's memory with the talker call command, see the talker for the protocol.  The registers
+// are passed in arg_regs and the registers the routine returns with are put back into it
+void talker_call(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, talker_regs *arg_regs){
+	uint8_t param_buf[6];
+	uint8_t rxbuf[4];
+
+	// Transmit command
+	param_buf[0] = TALKER_CALL_CMD;
+	txrx_chunk(arg_params, arg_serial_com, param_buf, rxbuf, 1, true);
+
+	// Transmit parameters
+	param_buf[0] = arg_regs->a;
+	param_buf[1] = (uint8_t)(arg_addr >> 8 & 0xff);
+	param_buf[2] = (uint8_t)(arg_addr & 0xff);
+	param_buf[3] = arg_regs->b;
+	param_buf[4] = (uint8_t)(arg_regs->y >> 8 & 0xff);
+	param_buf[5] = (uint8_t)(arg_regs->y & 0xff);
+	tx_chunk(arg_params, arg_serial_com, param_buf, 6);
+
+	// Registers of the routine when it returned
+	rx_chunk(arg_params, arg_serial_com, rxbuf, 4);
+	arg_regs->a = rxbuf[0];
+	arg_regs->b = rxbuf[1];
+	arg_regs->y = (uint16_t)(rxbuf[2] << 8 | rxbuf[3]);
+}
+
+// Scan routine, run with the talker call command with D = byte count and Y = address.  It returns with Y at the first
+// byte that was not expected and A = that byte, or else Y after the range.  It only uses relative branches so it runs
+// from wherever it is uploaded, the operands and opcodes marked are patched for the expected and written values and
+// the SCAN_OPT_ options
+static const uint8_t scan_routine[] = {
+	0x8f,              //      XGDX          X = byte count
+	0x18, 0xa6, 0x00,  // Loop LDAA $00,Y
+	0x81, 0x00,        //      CMPA #expected
+	0x26, 0x0a,        //      BNE Done      BRN with SCAN_OPT_ANY
+	0x86, 0x00,        //      LDAA #value
+	0x18, 0xa7, 0x00,  //      STAA $00,Y    CMPA $00,Y without SCAN_OPT_WRITE
+	0x18, 0x08,        //      INY           DEY with SCAN_OPT_DOWN
+	0x09,              //      DEX
+	0x26, 0xef,        //      BNE Loop
+	0x39               // Done RTS
+};
+
+// The scan routine as it is in the MCU's RAM, it is uploaded at the top of the block buffer below the talker's stack
+typedef struct{
+	uint16_t addr;
+	bool is_loaded;
+	uint8_t image[sizeof(scan_routine)];
+}scan_state;
+
+void scan_init(cl_my_params *arg_params, scan_state *arg_scan){
+	arg_scan->addr = (uint16_t)(arg_params->ram_size - TALKER_BLOCK_STACK_LEN - sizeof(scan_routine));
+	arg_scan->is_loaded = false;
+}
+
+// Patch the scan routine for the expected and written values and the options
+void scan_image(uint8_t arg_expected, uint8_t arg_value, uint8_t arg_options, uint8_t *arg_image){
+	memcpy(arg_image, scan_routine, sizeof(scan_routine));
+	arg_image[SCAN_EXPECTED_OFS] = arg_expected;
+	arg_image[SCAN_VALUE_OFS] = arg_value;
+	if(arg_options & SCAN_OPT_ANY){
+		arg_image[SCAN_BRANCH_OFS] = HC11_OP_BRN;
+	}
+	if(!(arg_options & SCAN_OPT_WRITE)){
+		arg_image[SCAN_STORE_OFS] = HC11_OP_CMPA_IND;
+	}
+	if(arg_options & SCAN_OPT_DOWN){
+		arg_image[SCAN_STEP_OFS] = HC11_OP_DEY;
+	}
+}
+
+// Upload the scan routine, once it is loaded only the bytes that changed are written
+void scan_load(cl_my_params *arg_params, serial_com *arg_serial_com, scan_state *arg_scan, uint8_t arg_expected, uint8_t arg_value, uint8_t arg_options){
+	uint8_t image[sizeof(scan_routine)];
+	uint8_t rxbuf[sizeof(scan_routine)];
+	uint32_t first = 0;
+	uint32_t last = sizeof(scan_routine) - 1;
+
+	scan_image(arg_expected, arg_value, arg_options, image);
+	if(arg_scan->is_loaded){
+		while(first < sizeof(image) && image[first] == arg_scan->image[first]){
+			first++;
+		}
+		if(first == sizeof(image)){
+			return;
+		}
+		while(image[last] == arg_scan->image[last]){
+			last--;
+		}
+	}
+
+	writemem_chunk(arg_params, arg_serial_com, TALKER_WRITE_CMD, (uint16_t)(arg_scan->addr + first), image + first, rxbuf, last - first + 1);
+	if(memcmp(rxbuf, image + first, last - first + 1) != 0){
+		arg_scan->is_loaded = false;
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_ROUTINE_ID, std::format(app_error_string::messages[APP_ERROR_ROUTINE_ID], arg_scan->addr), "");
+	}
+	memcpy(arg_scan->image, image, sizeof(image));
+	arg_scan->is_loaded = true;
+}
+
+// Scan a range of memory with the scan routine, in ascending order or with SCAN_OPT_DOWN descending
+// Returns true when all the bytes were expected, else false with the first byte that was not
+bool scan_range(cl_my_params *arg_params, serial_com *arg_serial_com, scan_state *arg_scan, uint16_t arg_from_addr, uint16_t arg_to_addr, uint8_t arg_expected, uint8_t arg_value, uint8_t arg_options, uint16_t *arg_bad_addr, uint8_t *arg_bad_value){
+	uint32_t from_addr = arg_from_addr;
+	uint32_t to_addr = arg_to_addr;
+	uint32_t remaining = (uint32_t)arg_to_addr - arg_from_addr + 1;
+	uint32_t len;
+	uint16_t end_addr;
+	talker_regs regs;
+
+	if(arg_to_addr < arg_from_addr){
+		return true;
+	}
+
+	scan_load(arg_params, arg_serial_com, arg_scan, arg_expected, arg_value, arg_options);
+	while(remaining){
+		len = (remaining > SCAN_MAX_LEN) ? SCAN_MAX_LEN : remaining;
+		regs.a = (uint8_t)(len >> 8 & 0xff);
+		regs.b = (uint8_t)(len & 0xff);
+		if(arg_options & SCAN_OPT_DOWN){
+			regs.y = (uint16_t)to_addr;
+			end_addr = (uint16_t)(to_addr - len);
+			to_addr -= len;
+		}else{
+			regs.y = (uint16_t)from_addr;
+			end_addr = (uint16_t)(from_addr + len);
+			from_addr += len;
+		}
+		talker_call(arg_params, arg_serial_com, arg_scan->addr, &regs);
+		if(regs.y != end_addr){
+			*arg_bad_addr = regs.y;
+			*arg_bad_value = regs.a;
+			return false;
+		}
+		remaining -= len;
+	}
+
+	return true;
+}
+
+// Blank check a range of memory.  Returns true when all the bytes are erased ($ff), else false with the first byte
+// that is not.  With the talker call command (RamSize > 512, not multi-drop) the scan routine checks the range on the
+// MCU and only the result comes back, else the range is read (a checksum can't prove a block blank, rle=y keeps the
+// erased runs short)
+bool blank_check_range(cl_my_params *arg_params, serial_com *arg_serial_com, scan_state *arg_scan, uint16_t arg_from_addr, uint16_t arg_to_addr, uint16_t *arg_bad_addr, uint8_t *arg_value){
+	uint32_t addr = arg_from_addr;
+	uint32_t remaining = (uint32_t)arg_to_addr - arg_from_addr + 1;
+	uint32_t block_len;
+	uint8_t rxbuf[TALKER_MAX_BYTE_COUNT];
+	uint32_t j;
+
+	if(is_call_talker(arg_params)){
+		return scan_range(arg_params, arg_serial_com, arg_scan, arg_from_addr, arg_to_addr, 0xff, 0xff, 0, arg_bad_addr, arg_value);
+	}
+	if(arg_to_addr < arg_from_addr){
+		return true;
+	}
+
+	while(remaining){
+		block_len = (remaining > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : remaining;
+		readmem_chunk(arg_params, arg_serial_com, (uint16_t)addr, rxbuf, block_len);
+		for(j = 0; j < block_len; j++){
+			if(rxbuf[j] != 0xff){
+				*arg_bad_addr = (uint16_t)(addr + j);
+				*arg_value = rxbuf[j];
+				return false;
+			}
+		}
+		addr += block_len;
+		remaining -= block_len;
+	}
+
+	return true;
+}
+
+// Blank check one range and show the result, a byte that is not blank is added to the mismatches
+bool blank_check_show(cl_my_params *arg_params, serial_com *arg_serial_com, scan_state *arg_scan, std::string arg_name, uint16_t arg_from_addr, uint16_t arg_to_addr){
+	uint16_t bad_addr;
+	uint8_t value;
+
+	*arg_params->out << "Blank checking " << arg_name << string_utils_ns::to_string_right_hex_up(arg_from_addr, 4, '0') << "-" << string_utils_ns::to_string_right_hex_up(arg_to_addr, 4, '0') << ": ";
+	if(blank_check_range(arg_params, arg_serial_com, arg_scan, arg_from_addr, arg_to_addr, &bad_addr, &value)){
+		*arg_params->out << "blank" << std::endl;
+		return true;
+	}
+
+	*arg_params->out << "not blank at " << string_utils_ns::to_string_right_hex_up(bad_addr, 4, '0') << " = " << string_utils_ns::to_string_right_hex_up((uint16_t)value, 2, '0') << std::endl;
+	if(arg_params->mismatches != NULL){
+		arg_params->mismatches->push_back({ bad_addr, 0xff, value });
+	}
+	return false;
+}
+
+// Blank check the from_addr to to_addr range, or with all=y every EEPROM and EPROM region of the MCU profile
+// Returns true when all the bytes are erased ($ff)
+bool blank_check(cl_my_params *arg_params, serial_com *arg_serial_com){
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	bool is_blank = true;
+	scan_state scan;
+	uint8_t i;
+
+	scan_init(arg_params, &scan);
+	if(arg_params->use_all){
+		if(profile == NULL){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MCU_NEEDED_ID, app_error_string::messages[APP_ERROR_MCU_NEEDED_ID], "all=y");
+		}
+		for(i = 0; i < profile->region_count; i++){
+			if(profile->regions[i].type == MEM_EEPROM || profile->regions[i].type == MEM_EPROM){
+				is_blank = blank_check_show(arg_params, arg_serial_com, &scan, std::string(mcu_mem_type_str(profile->regions[i].type)) + " ", profile->regions[i].start_addr, profile->regions[i].end_addr) && is_blank;
+			}
+		}
+	}else{
+		is_blank = blank_check_show(arg_params, arg_serial_com, &scan, "", (uint16_t)arg_params->from_addr, (uint16_t)arg_params->to_addr);
+	}
+
+	*arg_params->out << (is_blank ? "PASSED. Blank" : "FAILED! Not blank") << std::endl;
+	return is_blank;
+}
+
+// Blank check the S1 record ranges of a file before any EPROM byte is programmed, so a used part is rejected before
+// anything is written.  Contiguous records are checked as one range
+void blank_check_file(cl_my_params *arg_params, serial_com *arg_serial_com){
+	cl_my_file in_file;
+	std::string line_str;
+	std::vector<std::pair<uint16_t, uint32_t>> ranges;  // Start address and length
+	uint16_t srec_addr;
+	uint8_t srec_datacount;
+	uint16_t bad_addr;
+	uint8_t value;
+	scan_state scan;
+
+	scan_init(arg_params, &scan);
+	in_file.open_file(arg_params->full_file_name, "rb");
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+			srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
+			if(!ranges.empty() && ranges.back().first + ranges.back().second == srec_addr){
+				ranges.back().second += srec_datacount;
+			}else if(srec_datacount){
+				ranges.push_back({ srec_addr, srec_datacount });
+			}
+		}
+	}while(!in_file.eof());
+
+	*arg_params->out << "Blank checking the EPROM of the file" << std::endl;
+	for(const std::pair<uint16_t, uint32_t> &range : ranges){
+		if(!blank_check_range(arg_params, arg_serial_com, &scan, range.first, (uint16_t)(range.first + range.second - 1), &bad_addr, &value)){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_NOT_BLANK_ID, std::format(app_error_string::messages[APP_ERROR_NOT_BLANK_ID], bad_addr, value), "");
+		}
+	}
+}
+
+// Reject a write to the wrong memory type for the MCU profile, e.g. write_ee to EPROM.  Unmapped addresses are
+// external memory so only a normal write may use them
+void check_write_range(cl_my_params *arg_params, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint32_t arg_len){
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	const mcu_region *region;
+	uint32_t i;
+	bool is_allowed;
+
+	if(profile == NULL){
+		return;
+	}
+
+	for(i = 0; i < arg_len; i++){
+		region = mcu_profile_find_region(profile, (uint16_t)(arg_addr + i));
+		switch(arg_write_cmd_code){
+			case TALKER_WRITE_EE_CMD:
+				is_allowed = region != NULL && (region->type == MEM_EEPROM || region->type == MEM_CONFIG);
+				break;
+			case TALKER_WRITE_E_CMD:
+			case TALKER_WRITE_E20_CMD:
+				is_allowed = region != NULL && region->type == MEM_EPROM;
+				break;
+			default:
+				is_allowed = region == NULL || region->type == MEM_RAM || region->type == MEM_REG || region->type == MEM_CONFIG;
+				break;
+		}
+		if(!is_allowed){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MEM_TYPE_ID, std::format(app_error_string::messages[APP_ERROR_MEM_TYPE_ID], (uint16_t)(arg_addr + i), (region != NULL) ? mcu_mem_type_str(region->type) : "unmapped", profile->name), "");
+		}
+	}
+
+	// The E20 EPROM is programmed differently to the other EPROMs
+	if((arg_write_cmd_code == TALKER_WRITE_E_CMD && profile->eprom_cmd != CMD_WRITE_E) || (arg_write_cmd_code == TALKER_WRITE_E20_CMD && profile->eprom_cmd != CMD_WRITE_E20)){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_EPROM_CMD_ID, std::format(app_error_string::messages[APP_ERROR_EPROM_CMD_ID], profile->name, (profile->eprom_cmd == CMD_WRITE_E20) ? "write_e20" : "write_e"), "");
+	}
+}
+
+// Check all the S1 records of a file before anything is written
+void check_write_file(cl_my_params *arg_params, uint8_t arg_write_cmd_code){
+	cl_my_file in_file;
+	std::string line_str;
+
+	if(mcu_profile_find(arg_params->mcu_name) == NULL){
+		return;
+	}
+
+	in_file.open_file(arg_params->full_file_name, "rb");
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			check_write_range(arg_params, arg_write_cmd_code, (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16), (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT);
+		}
+	}while(!in_file.eof());
+}
+
+// Check a write command against the MCU profile, before the programming confirmation
+void check_write(cl_my_params *arg_params, uint8_t arg_write_cmd_code){
+	if(arg_params->cmd == CMD_WRITE_NORMAL_HEXSTR || arg_params->cmd == CMD_WRITE_EE_HEXSTR){
+		check_write_range(arg_params, arg_write_cmd_code, (uint16_t)arg_params->from_addr, ((uint32_t)arg_params->data.size() + 1) / 2);
+	}else{
+		check_write_file(arg_params, arg_write_cmd_code);
+	}
+
+	if(arg_params->pulse_width && (arg_write_cmd_code == TALKER_WRITE_E_CMD || arg_write_cmd_code == TALKER_WRITE_E20_CMD) && (arg_params->pulse_max == 0 || arg_params->ram_size <= BOOTLOADER_MAX_BYTE_COUNT)){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_PULSE_ID, app_error_string::messages[APP_ERROR_PULSE_ID], "");
+	}
+	if(arg_params->pulse_width && (arg_write_cmd_code == TALKER_WRITE_E_CMD || arg_write_cmd_code == TALKER_WRITE_E20_CMD) && !arg_params->units.empty()){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MDROP_PULSE_ID, app_error_string::messages[APP_ERROR_MDROP_PULSE_ID], "");
+	}
+	if(arg_params->use_block && arg_write_cmd_code != TALKER_WRITE_CMD && arg_params->ram_size <= 512){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_BLOCK_ID, app_error_string::messages[APP_ERROR_BLOCK_ID], "");
+	}
+}
+
+// Check a memory test command before the programming confirmation of the EEPROM cell test
+void check_memtest(cl_my_params *arg_params){
+	if(!is_call_talker(arg_params)){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MEMTEST_ID, app_error_string::messages[APP_ERROR_MEMTEST_ID], "");
+	}
+	if(arg_params->to_addr < arg_params->from_addr || arg_params->to_addr > 0xffff){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MEMTEST_RANGE_ID, std::format(app_error_string::messages[APP_ERROR_MEMTEST_RANGE_ID], arg_params->from_addr, arg_params->to_addr), "");
+	}
+	if(arg_params->from_addr < HC11_REG_ADDR + HC11_REG_LEN && arg_params->to_addr >= HC11_REG_ADDR){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MEMTEST_REG_ID, std::format(app_error_string::messages[APP_ERROR_MEMTEST_REG_ID], HC11_REG_ADDR, HC11_REG_ADDR + HC11_REG_LEN - 1), "");
+	}
+	check_write_range(arg_params, arg_params->use_ee ? TALKER_WRITE_EE_CMD : TALKER_WRITE_CMD, (uint16_t)arg_params->from_addr, arg_params->to_addr - arg_params->from_addr + 1);
+}
+
+// Record a memory test failure, returns false once there are MEMTEST_MAX_FAILS of them
+bool memtest_fail(cl_my_params *arg_params, std::vector<mem_mismatch> *arg_fails, uint16_t arg_addr, uint8_t arg_expected, uint8_t arg_actual){
+	*arg_params->out << "Failed at " << string_utils_ns::to_string_right_hex_up(arg_addr, 4, '0') << ": expected " << string_utils_ns::to_string_right_hex_up((uint16_t)arg_expected, 2, '0') << ", read " << string_utils_ns::to_string_right_hex_up((uint16_t)arg_actual, 2, '0') << std::endl;
+	arg_fails->push_back({ arg_addr, arg_expected, arg_actual });
+	if(arg_params->mismatches != NULL){
+		arg_params->mismatches->push_back({ arg_addr, arg_expected, arg_actual });
+	}
+
+	return arg_fails->size() < MEMTEST_MAX_FAILS;
+}
+
+// One March element over a range with the scan routine, a failing byte is recorded and the scan goes on from
+// the next one.  Returns false once there are MEMTEST_MAX_FAILS failures
+bool memtest_element(cl_my_params *arg_params, serial_com *arg_serial_com, scan_state *arg_scan, uint16_t arg_from_addr, uint16_t arg_to_addr, uint8_t arg_expected, uint8_t arg_value, uint8_t arg_options, std::vector<mem_mismatch> *arg_fails){
+	int32_t from_addr = arg_from_addr;
+	int32_t to_addr = arg_to_addr;
+	uint16_t bad_addr;
+	uint8_t bad_value;
+
+	while(from_addr <= to_addr){
+		if(scan_range(arg_params, arg_serial_com, arg_scan, (uint16_t)from_addr, (uint16_t)to_addr, arg_expected, arg_value, arg_options, &bad_addr, &bad_value)){
+			break;
+		}
+		if(!memtest_fail(arg_params, arg_fails, bad_addr, arg_expected, bad_value)){
+			return false;
+		}
+		if(arg_options & SCAN_OPT_DOWN){
+			to_addr = (int32_t)bad_addr - 1;
+		}else{
+			from_addr = (int32_t)bad_addr + 1;
+		}
+	}
+
+	return true;
+}
+
+// March C- RAM test of the from_addr to to_addr range, skipping the talker, the scan routine and the stack.  Each
+// element is one run of the scan routine over the range, so only the failures come back.  It is run with data backgrounds $00, $55, $33 and $0f, which
+// also find coupling between the bits of a byte.  The RAM contents are lost
+bool memtest_ram(cl_my_params *arg_params, serial_com *arg_serial_com){
+	// March C-: {any(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); any(r0)}, 1 is the complement
+	static const struct{
+		uint8_t options;
+		bool is_expected_inv;
+		bool is_value_inv;
+	}elements[] = {
+		{ SCAN_OPT_ANY | SCAN_OPT_WRITE, false, false },
+		{ SCAN_OPT_WRITE, false, true },
+		{ SCAN_OPT_WRITE, true, false },
+		{ SCAN_OPT_DOWN | SCAN_OPT_WRITE, false, true },
+		{ SCAN_OPT_DOWN | SCAN_OPT_WRITE, true, false },
+		{ 0, false, false }
+	};
+	static const uint8_t backgrounds[] = { 0x00, 0x55, 0x33, 0x0f };
+	uint32_t talker_end = get_srec_data_count(arg_params->talker_filename);  // The talker is loaded from address 0
+	std::vector<std::pair<uint16_t, uint16_t>> ranges;
+	std::vector<mem_mismatch> fails;
+	scan_state scan;
+	uint32_t byte_count = 0;
+	uint32_t from_addr;
+	uint32_t to_addr;
+	size_t i;
+	size_t j;
+	size_t k;
+	bool is_done = false;
+
+	// The internal RAM between the talker and the scan routine below its stack, then above the internal RAM
+	scan_init(arg_params, &scan);
+	from_addr = std::max(arg_params->from_addr, talker_end);
+	to_addr = std::min(arg_params->to_addr, (uint32_t)scan.addr - 1);
+	if(from_addr <= to_addr){
+		ranges.push_back({ (uint16_t)from_addr, (uint16_t)to_addr });
+		byte_count += to_addr - from_addr + 1;
+	}
+	from_addr = std::max(arg_params->from_addr, arg_params->ram_size);
+	to_addr = arg_params->to_addr;
+	if(from_addr <= to_addr){
+		ranges.push_back({ (uint16_t)from_addr, (uint16_t)to_addr });
+		byte_count += to_addr - from_addr + 1;
+	}
+	if(arg_params->from_addr < talker_end || (arg_params->from_addr < arg_params->ram_size && arg_params->to_addr >= scan.addr)){
+		*arg_params->out << "Skipping the talker 0000-" << string_utils_ns::to_string_right_hex_up((uint16_t)(talker_end - 1), 4, '0') << ", the scan routine and the stack " << string_utils_ns::to_string_right_hex_up(scan.addr, 4, '0') << "-" << string_utils_ns::to_string_right_hex_up((uint16_t)(arg_params->ram_size - 1), 4, '0') << std::endl;
+	}
+
+	for(const std::pair<uint16_t, uint16_t> &range : ranges){
+		*arg_params->out << "March C- testing " << string_utils_ns::to_string_right_hex_up(range.first, 4, '0') << "-" << string_utils_ns::to_string_right_hex_up(range.second, 4, '0') << std::endl;
+	}
+	for(i = 0; i < sizeof(backgrounds) && !is_done; i++){
+		for(j = 0; j < sizeof(elements) / sizeof(elements[0]) && !is_done; j++){
+			// A descending element takes the ranges from the top
+			for(k = 0; k < ranges.size() && !is_done; k++){
+				const std::pair<uint16_t, uint16_t> &range = (elements[j].options & SCAN_OPT_DOWN) ? ranges[ranges.size() - 1 - k] : ranges[k];
+				is_done = !memtest_element(arg_params, arg_serial_com, &scan, range.first, range.second, (uint8_t)(elements[j].is_expected_inv ? ~backgrounds[i] : backgrounds[i]), (uint8_t)(elements[j].is_value_inv ? ~backgrounds[i] : backgrounds[i]), elements[j].options, &fails);
+			}
+		}
+		report_progress(arg_params, (uint32_t)(i + 1) * byte_count, (uint32_t)sizeof(backgrounds) * byte_count);
+	}
+
+	if(fails.size()){
+		*arg_params->out << "FAILED! " << byte_count << " bytes, " << fails.size() << " failure(s)" << (is_done ? ", stopped at the limit" : "") << std::endl;
+	}else{
+		*arg_params->out << "PASSED. " << byte_count << " bytes, " << sizeof(backgrounds) << " x " << sizeof(elements) / sizeof(elements[0]) << " March elements" << std::endl;
+	}
+	return fails.empty();
+}
+
+// EEPROM cell test of the from_addr to to_addr range: each cell is programmed with $55 then $aa, reread as it is
+// programmed, and after each pattern the whole range is checked with the scan routine so a cell disturbed by programming
+// the others is found.  The original contents are read first and programmed back at the end
+bool memtest_ee(cl_my_params *arg_params, serial_com *arg_serial_com){
+	static const uint8_t patterns[] = { 0x55, 0xaa };
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	uint32_t len = arg_params->to_addr - arg_params->from_addr + 1;
+	std::vector<uint8_t> original(len);
+	std::vector<uint8_t> txbuf(len);
+	std::vector<uint8_t> rxbuf(len);
+	std::vector<mem_mismatch> fails;
+	uint32_t chunklen;
+	uint32_t i;
+	uint32_t j;
+	uint32_t k;
+	bool is_restore;
+	bool is_done = false;
+	scan_state scan;
+
+	scan_init(arg_params, &scan);
+	*arg_params->out << "EEPROM cell testing " << string_utils_ns::to_string_right_hex_up((uint16_t)arg_params->from_addr, 4, '0') << "-" << string_utils_ns::to_string_right_hex_up((uint16_t)arg_params->to_addr, 4, '0') << std::endl;
+	for(i = 0; i < len; i += chunklen){
+		chunklen = get_chunk_len(profile, (uint16_t)(arg_params->from_addr + i), len - i);
+		readmem_chunk(arg_params, arg_serial_com, (uint16_t)(arg_params->from_addr + i), original.data() + i, chunklen);
+	}
+
+	for(j = 0; j <= sizeof(patterns); j++){
+		// The last pass programs the original contents back, also after the failure limit
+		is_restore = (j == sizeof(patterns));
+		if(is_done && !is_restore){
+			continue;
+		}
+		if(!is_restore){
+			*arg_params->out << "Pattern " << string_utils_ns::to_string_right_hex_up((uint16_t)patterns[j], 2, '0') << std::endl;
+			memset(txbuf.data(), patterns[j], len);
+		}else{
+			*arg_params->out << "Restoring the original contents" << std::endl;
+			memcpy(txbuf.data(), original.data(), len);
+		}
+		for(i = 0; i < len; i += chunklen){
+			chunklen = get_chunk_len(profile, (uint16_t)(arg_params->from_addr + i), len - i);
+			writemem_chunk(arg_params, arg_serial_com, TALKER_WRITE_EE_CMD, (uint16_t)(arg_params->from_addr + i), txbuf.data() + i, rxbuf.data() + i, chunklen);
+			for(k = i; k < i + chunklen && !is_done; k++){
+				if(rxbuf[k] != txbuf[k]){
+					is_done = !memtest_fail(arg_params, &fails, (uint16_t)(arg_params->from_addr + k), txbuf[k], rxbuf[k]);
+				}
+			}
+			report_progress(arg_params, j * len + i + chunklen, (uint32_t)(sizeof(patterns) + 1) * len);
+		}
+		if(!is_restore && !is_done){
+			is_done = !memtest_element(arg_params, arg_serial_com, &scan, (uint16_t)arg_params->from_addr, (uint16_t)arg_params->to_addr, patterns[j], 0, 0, &fails);
+		}
+	}
+
+	if(fails.size()){
+		*arg_params->out << "FAILED! " << len << " bytes, " << fails.size() << " failure(s)" << (is_done ? ", stopped at the limit" : "") << std::endl;
+	}else{
+		*arg_params->out << "PASSED. " << len << " bytes, " << sizeof(patterns) << " patterns and the original contents" << std::endl;
+	}
+	return fails.empty();
+}
+
+// RAM test, or with ee=y EEPROM cell test, of the from_addr to to_addr range, check_memtest() first.  Returns true
+// when it passed
+bool memtest(cl_my_params *arg_params, serial_com *arg_serial_com){
+	return arg_params->use_ee ? memtest_ee(arg_params, arg_serial_com) : memtest_ram(arg_params, arg_serial_com);
+}
+
+// Check a call command before anything is sent
+void check_call(cl_my_params *arg_params){
+	if(!is_call_talker(arg_params)){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_CALL_ID, app_error_string::messages[APP_ERROR_CALL_ID], "");
+	}
+	if(arg_params->data.size() > 0){
+		check_write_range(arg_params, TALKER_WRITE_CMD, (uint16_t)arg_params->from_addr, ((uint32_t)arg_params->data.size() + 1) / 2);
+	}
+}
+
+// Write the hex string routine, if any, to from_addr and call it with the reg_ registers, check_call() first.  The
+// registers it returns with are put into arg_regs
+void call_routine(cl_my_params *arg_params, serial_com *arg_serial_com, talker_regs *arg_regs){
+	writemem_hexstr(arg_params, arg_serial_com, TALKER_WRITE_CMD);
+	arg_regs->a = arg_params->reg_a;
+	arg_regs->b = arg_params->reg_b;
+	arg_regs->y = arg_params->reg_y;
+	*arg_params->out << "Calling " << string_utils_ns::to_string_right_hex_up((uint16_t)arg_params->from_addr, 4, '0') << " with A=" << string_utils_ns::to_string_right_hex_up((uint16_t)arg_regs->a, 2, '0') << " B=" << string_utils_ns::to_string_right_hex_up((uint16_t)arg_regs->b, 2, '0') << " Y=" << string_utils_ns::to_string_right_hex_up(arg_regs->y, 4, '0') << std::endl;
+	talker_call(arg_params, arg_serial_com, (uint16_t)arg_params->from_addr, arg_regs);
+	*arg_params->out << "Returned A=" << string_utils_ns::to_string_right_hex_up((uint16_t)arg_regs->a, 2, '0') << " B=" << string_utils_ns::to_string_right_hex_up((uint16_t)arg_regs->b, 2, '0') << " Y=" << string_utils_ns::to_string_right_hex_up(arg_regs->y, 4, '0') << std::endl;
+}
+
+void writemem_hexstr(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code){
+	uint16_t addr;
+	uint32_t chunklen = 0;
+	uint32_t remaining;
+	uint32_t total_bytes;
+	cl_my_buf txbuf;
+	uint8_t *txbuf_p;
+	cl_my_buf rxbuf;
+	uint8_t *rxbuf_p;
+
+	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
+	txbuf_p = txbuf.get_buf();
+	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
+	rxbuf_p = rxbuf.get_buf();
+
+	if(arg_params->data.size() > 0){
+		if(arg_params->data.size() % 2){
+			arg_params->data = "0" + arg_params->data;
+		}
+
+		total_bytes = arg_params->data.size() / 2;
+		addr = arg_params->from_addr;
+		remaining = total_bytes;
+
+		*arg_params->out << string_utils_ns::to_string_right_hex_up(arg_params->from_addr, 4, '0') << ":" << arg_params->data << std::endl;
+
+		// Loop each data byte
+		while(remaining){
+			chunklen = (remaining > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : remaining;
+
+			// Write and receive a chunk of memory
+			txbuf_p = txbuf.get_buf();
+			rxbuf_p = rxbuf.get_buf();
+			for(uint16_t i = 0; i < chunklen; i++){
+				txbuf_p[i] = (uint8_t)strtoul(arg_params->data.substr(2 * (addr - arg_params->from_addr + i), 2).c_str(), NULL, 16);
+			}
+			writemem_chunk(arg_params, arg_serial_com, arg_write_cmd_code, addr, txbuf_p, rxbuf_p, chunklen);
+
+			addr += chunklen;
+			remaining -= chunklen;
+			report_progress(arg_params, total_bytes - remaining, total_bytes);
+		}
+	}
+}
+
+// Identify the image and write command of a journal, with a CRC-16 of the S1 record addresses and data
+std::string get_journal_id(cl_my_params *arg_params, uint8_t arg_write_cmd_code){
+	cl_my_file in_file;
+	std::string line_str;
+	std::vector<uint8_t> image;
+	uint8_t srec_datacount;
+	uint32_t i;
+
+	in_file.open_file(arg_params->full_file_name, "rb");
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+			srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+			for(i = 0; i < (uint32_t)srec_datacount + 2 && line_str.size() >= 2 * i + 6; i++){
+				image.push_back((uint8_t)strtoul(line_str.substr(2 * i + 4, 2).c_str(), NULL, 16));
+			}
+		}
+	}while(!in_file.eof());
+
+	return std::format("{:02x} {:04x} {}", arg_write_cmd_code, crc16(image.data(), (uint32_t)image.size()), image.size());
+}
+
+// Journal region of an address, the index of its MCU profile region
+uint8_t get_journal_region(const mcu_profile *arg_profile, uint16_t arg_addr){
+	const mcu_region *region = (arg_profile != NULL) ? mcu_profile_find_region(arg_profile, arg_addr) : NULL;
+
+	return (region != NULL) ? (uint8_t)(region - arg_profile->regions) : JOURNAL_REGION_COUNT - 1;
+}
+
+// Load the journal of a previous run of the same write, if any.  Each line after the header is a region index and
+// the last verified address of the region in hex
+void load_journal(cl_my_params *arg_params, uint8_t arg_write_cmd_code, write_journal *arg_journal){
+	cl_my_file in_file;
+	std::string line_str;
+	char *end_p;
+	uint32_t region;
+	uint32_t i;
+
+	for(i = 0; i < JOURNAL_REGION_COUNT; i++){
+		arg_journal->marks[i] = -1;
+		arg_journal->last_addrs[i] = -1;
+		arg_journal->is_frozen[i] = false;
+	}
+	arg_journal->is_resumed = false;
+	arg_journal->skip_count = 0;
+
+	if(arg_params->journal_filename.empty()){
+		return;
+	}
+	arg_journal->id = get_journal_id(arg_params, arg_write_cmd_code);
+
+	try{
+		in_file.open_file(arg_params->journal_filename, "rb");
+	}catch(tru_exception &ex){
+		(void)ex;  // Suppress unreferenced warning, no previous run
+		return;
+	}
+
+	line_str.clear();
+	in_file.read_file_line(line_str);
+	if(line_str != JOURNAL_HEADER + arg_journal->id){
+		*arg_params->out << "Journal " << arg_params->journal_filename << " is for another image or write command, writing all" << std::endl;
+		return;
+	}
+	do{
+		line_str.clear();
+		in_file.read_file_line(line_str);
+		region = (uint32_t)strtoul(line_str.c_str(), &end_p, 10);
+		if(end_p != line_str.c_str() && region < JOURNAL_REGION_COUNT){
+			arg_journal->marks[region] = (int32_t)strtoul(end_p, NULL, 16);
+			arg_journal->is_resumed = true;
+		}
+	}while(!in_file.eof());
+}
+
+void save_journal(cl_my_params *arg_params, write_journal *arg_journal){
+	cl_my_file out_file;
+	std::string journal_str = JOURNAL_HEADER + arg_journal->id + "\n";
+	size_t bytes_written;
+
+	for(uint32_t i = 0; i < JOURNAL_REGION_COUNT; i++){
+		if(arg_journal->marks[i] >= 0){
+			journal_str += std::format("{} {:04x}\n", i, arg_journal->marks[i]);
+		}
+	}
+
+	out_file.open_file(arg_params->journal_filename, "wb");
+	out_file.write_file(journal_str.c_str(), journal_str.size(), bytes_written);
+}
+
+// Write a block of S-record data and show the result
+// When programming EPROM with adaptive pulses, arg_pulse_counts counts the bytes by the pulses they took, else it is NULL
+// With arg_is_readback the block has already been read back into arg_rxbuf and is only shown
+void writemem_file_block(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len, uint32_t *arg_mismatch_count, uint32_t *arg_ignore_count, uint32_t *arg_pulse_counts, bool arg_is_readback){
+	uint32_t i;
+	uint16_t addr = arg_addr;
+	uint32_t line_mismatch_count = 0;
+	uint32_t line_ignore_count = 0;
+	std::vector<uint8_t> pulsebuf(arg_len);
+	uint8_t min_pulses = 255;
+	uint8_t max_pulses = 0;
+
+	*arg_params->out << string_utils_ns::to_string_right_hex_up(arg_addr, 4, '0') << ":";
+	for(i = 0; i < arg_len; i++){
+		*arg_params->out << string_utils_ns::to_string_right_hex_up((uint16_t)arg_txbuf[i], 2, '0');
+	}
+
+	// Write and receive a chunk of memory
+	if(arg_is_readback){
+		*arg_params->out << " read back";
+	}else if(arg_pulse_counts != NULL){
+		writemem_pulse_chunk(arg_params, arg_serial_com, arg_write_cmd_code, arg_addr, arg_txbuf, arg_rxbuf, pulsebuf.data(), arg_len);
+		for(i = 0; i < arg_len; i++){
+			arg_pulse_counts[pulsebuf[i]]++;
+			min_pulses = (pulsebuf[i] < min_pulses) ? pulsebuf[i] : min_pulses;
+			max_pulses = (pulsebuf[i] > max_pulses) ? pulsebuf[i] : max_pulses;
+		}
+		*arg_params->out << " " << (uint16_t)min_pulses << "-" << (uint16_t)max_pulses << " pulses";
+	}else{
+		writemem_chunk(arg_params, arg_serial_com, arg_write_cmd_code, arg_addr, arg_txbuf, arg_rxbuf, arg_len);
+	}
+
+	for(i = 0; i < arg_len; i++){
+		if(!arg_params->verify_config && addr == HC11_CONFIG_ADDR){  // We cannot read the new config value until after a reset so we will not verify it
+			line_ignore_count++;
+			(*arg_ignore_count)++;
+		}else{
+			if(arg_txbuf[i] != arg_rxbuf[i]){
+				line_mismatch_count++;
+				(*arg_mismatch_count)++;
+				if(arg_params->mismatches != NULL){
+					arg_params->mismatches->push_back({ addr, arg_txbuf[i], arg_rxbuf[i] });
+				}
+			}
+		}
+		addr++;
+	}
+
+	if(line_mismatch_count && line_ignore_count){
+		*arg_params->out << " = " << line_mismatch_count << " mismatched, " << line_ignore_count << " ignored" << std::endl;
+	}else if(line_mismatch_count){
+		*arg_params->out << " = " << line_mismatch_count << " mismatched" << std::endl;
+	}else if(line_ignore_count == arg_len){
+		*arg_params->out << " = " << line_ignore_count << " ignored" << std::endl;
+	}else if(line_ignore_count){
+		*arg_params->out << " = " << arg_len << " matched, " << line_ignore_count << " ignored" << std::endl;
+	}else{
+		*arg_params->out << " = " << arg_len << " matched" << std::endl;
+	}
+}
+
+// Advance a region's journal mark to arg_end_addr, the last byte verified in ascending order, and save the journal
+void advance_journal(cl_my_params *arg_params, write_journal *arg_journal, uint8_t arg_region, int32_t arg_end_addr){
+	if(arg_journal->is_frozen[arg_region] || arg_end_addr <= arg_journal->marks[arg_region]){
+		return;
+	}
+
+	arg_journal->marks[arg_region] = arg_end_addr;
+	if(!arg_params->journal_filename.empty()){
+		save_journal(arg_params, arg_journal);
+	}
+}
+
+// Write a block of S-record data, skipping the bytes the journal has verified by a previous run and retrying after a
+// link error.  A region's journal mark only advances while its bytes are verified in ascending order, so skipping the
+// bytes up to the mark never skips one that was not verified
+// After a link error the rest of the block is read back, the bytes that already match are not written again (EPROM
+// bytes are not pulsed again) and the write resumes from the first byte that does not match
+void writemem_journal_block(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len, uint32_t *arg_mismatch_count, uint32_t *arg_ignore_count, uint32_t *arg_pulse_counts, write_journal *arg_journal){
+	uint8_t region = get_journal_region(mcu_profile_find(arg_params->mcu_name), arg_addr);
+	int32_t end_addr = (int32_t)arg_addr + (int32_t)arg_len - 1;
+	uint8_t retries = arg_params->retry_count;
+	bool is_readback = false;
+	uint32_t error_mark;
+	uint32_t ofs = 0;  // The bytes before it are written
+	uint32_t readback_end = 0;  // The bytes from ofs up to it were read back into arg_rxbuf
+	uint32_t run_len;
+	uint32_t prev_mismatch_count;
+	bool is_match;
+
+	if((int32_t)arg_addr <= arg_journal->last_addrs[region]){
+		// Out of order, this region cannot be resumed from a mark
+		arg_journal->marks[region] = -1;
+		arg_journal->is_frozen[region] = true;
+	}else if(!arg_journal->is_frozen[region] && (int32_t)arg_addr <= arg_journal->marks[region]){
+		ofs = (end_addr <= arg_journal->marks[region]) ? arg_len : (uint32_t)(arg_journal->marks[region] - arg_addr + 1);
+		arg_journal->skip_count += ofs;
+	}
+	if(end_addr > arg_journal->last_addrs[region]){
+		arg_journal->last_addrs[region] = end_addr;
+	}
+
+	while(ofs < arg_len){
+		error_mark = line_error_count(arg_serial_com);
+		prev_mismatch_count = *arg_mismatch_count;
+		try{
+			// After a link error, some of the bytes may have been written before the error
+			if(is_readback){
+				readmem_chunk(arg_params, arg_serial_com, (uint16_t)(arg_addr + ofs), arg_rxbuf + ofs, arg_len - ofs);
+				readback_end = arg_len;
+				is_readback = false;
+			}
+
+			if(ofs < readback_end){
+				// A run of bytes read back that all match, which is only shown, or that all do not, which is written
+				is_match = arg_txbuf[ofs] == arg_rxbuf[ofs];
+				run_len = 1;
+				while(ofs + run_len < readback_end && (arg_txbuf[ofs + run_len] == arg_rxbuf[ofs + run_len]) == is_match){
+					run_len++;
+				}
+			}else{
+				is_match = false;
+				run_len = arg_len - ofs;
+			}
+			writemem_file_block(arg_params, arg_serial_com, arg_write_cmd_code, (uint16_t)(arg_addr + ofs), arg_txbuf + ofs, arg_rxbuf + ofs, run_len, arg_mismatch_count, arg_ignore_count, arg_pulse_counts, is_match);
+		}catch(tru_exception &ex){
+			// A lower baud rate does not use up a retry
+			if(!fallback_baud(arg_params, arg_serial_com, &ex, error_mark)){
+				if(retries == 0){
+					throw;
+				}
+				retries--;
+				*arg_params->out << std::endl << "Link error: " << ex.get_message() << std::endl;
+				resync_talker(arg_params, arg_serial_com, !arg_params->is_prog_data);
+			}
+			is_readback = true;
+			continue;
+		}
+
+		if(*arg_mismatch_count != prev_mismatch_count){
+			arg_journal->is_frozen[region] = true;
+		}
+		ofs += run_len;
+		advance_journal(arg_params, arg_journal, region, (int32_t)arg_addr + (int32_t)ofs - 1);
+	}
+}
+
+// Note, when programming the CONFIG register 0x103f the new value cannot be read until a reset
+// When compressing or with block writes, contiguous S1 records are merged into blocks of up to TALKER_MAX_BYTE_COUNT
+// Returns true when all bytes matched
+bool writemem_file(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code){
+	uint32_t i;
+	cl_my_file in_file;
+	std::string line_str;
+	std::string srec_type;
+	uint8_t srec_datacount;
+	uint32_t total_databytes = 0;
+	uint16_t srec_addr;
+	cl_my_buf txbuf;
+	uint8_t *txbuf_p;
+	cl_my_buf rxbuf;
+	uint32_t mismatch_count = 0;
+	uint32_t ignore_count = 0;
+	uint16_t block_addr = 0;
+	uint32_t block_len = 0;
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	std::vector<uint32_t> pulse_counts(256);  // Bytes programmed by pulse count
+	bool is_pulse = arg_params->pulse_width && (arg_write_cmd_code == TALKER_WRITE_E_CMD || arg_write_cmd_code == TALKER_WRITE_E20_CMD);
+	write_journal journal;
+	uint32_t file_databytes = arg_params->on_progress ? get_srec_data_count(arg_params->full_file_name) : 0;  // Total for the progress hook
+
+	load_journal(arg_params, arg_write_cmd_code, &journal);
+	if(journal.is_resumed){
+		*arg_params->out << "Resuming from journal " << arg_params->journal_filename << std::endl;
+		resync_talker(arg_params, arg_serial_com, false);  // The killed run may have left a programming command in its data loop
+	}else if(arg_params->use_blank && (arg_write_cmd_code == TALKER_WRITE_E_CMD || arg_write_cmd_code == TALKER_WRITE_E20_CMD)){
+		// Blank check only a fresh write, a resumed one has already programmed part of the image
+		blank_check_file(arg_params, arg_serial_com);
+	}
+
+	txbuf.alloc_buf((arg_params->serial_txbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_txbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
+	txbuf_p = txbuf.get_buf();
+	rxbuf.alloc_buf((arg_params->serial_rxbuf_size > BOOTLOADER_MAX_BYTE_COUNT) ? arg_params->serial_rxbuf_size : BOOTLOADER_MAX_BYTE_COUNT);
+
+	in_file.open_file(arg_params->full_file_name, "rb");
+
+	do{
+		// Read line from file
+		in_file.read_file_line(line_str);
+
+		// Record string length must be atleast the minimum of 8
+		if(line_str.size() >= 8){
+			// We only want S1 records
+			srec_type = line_str.substr(0, 2);
+			if(srec_type == "S1"){
+				//std::cout << line_str << std::endl;
+				srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;  // Extract srecord data byte count
+				srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);  // Extract srecord address
+
+				// Write the block when this record cannot be appended to it, without compression or block writes each record is a block
+				if(block_len && ((!arg_params->use_compress && !arg_params->use_block) || (uint16_t)(block_addr + block_len) != srec_addr || block_len + srec_datacount > get_chunk_len(profile, block_addr, 0x10000))){
+					writemem_journal_block(arg_params, arg_serial_com, arg_write_cmd_code, block_addr, txbuf.get_buf(), rxbuf.get_buf(), block_len, &mismatch_count, &ignore_count, is_pulse ? pulse_counts.data() : NULL, &journal);
+					report_progress(arg_params, total_databytes, file_databytes);
+					block_len = 0;
+				}
+				if(block_len == 0){
+					block_addr = srec_addr;
+				}
+
+				// Loop each data byte appending them into a buffer
+				txbuf_p = txbuf.get_buf() + block_len;
+				for(i = 0; i < srec_datacount; i++){
+					*txbuf_p = (uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16);
+					txbuf_p++;
+				}
+				block_len += srec_datacount;
+
+				total_databytes += srec_datacount;
+			}
+		}
+	}while(!in_file.eof());
+
+	// Write the last block
+	if(block_len){
+		writemem_journal_block(arg_params, arg_serial_com, arg_write_cmd_code, block_addr, txbuf.get_buf(), rxbuf.get_buf(), block_len, &mismatch_count, &ignore_count, is_pulse ? pulse_counts.data() : NULL, &journal);
+		report_progress(arg_params, total_databytes, file_databytes);
+	}
+
+	if(journal.skip_count){
+		*arg_params->out << journal.skip_count << " byte(s) verified by a previous run were not written again" << std::endl;
+	}
+	if(mismatch_count == 0 && !arg_params->journal_filename.empty()){
+		remove(arg_params->journal_filename.c_str());  // Done, a journal left behind would skip the next MCU's write
+	}
+
+	if(mismatch_count){
+		if(ignore_count){
+			*arg_params->out << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched, " << ignore_count << " ignored" << std::endl;
+		}else{
+			*arg_params->out << "FAILED! " << total_databytes << " total bytes, " << mismatch_count << " mismatched" << std::endl;
+		}
+	}else{
+		if(ignore_count){
+			*arg_params->out << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched, " << ignore_count <<  " ignored" << std::endl;
+		}else{
+			*arg_params->out << "PASSED. " << total_databytes << " total bytes, " << total_databytes - ignore_count << " matched" << std::endl;
+		}
+	}
+
+	if(is_pulse){
+		*arg_params->out << "Pulse width " << arg_params->pulse_width / 10 << "." << arg_params->pulse_width % 10 << "ms, bytes by pulse count:";
+		for(i = 0; i < pulse_counts.size(); i++){
+			if(pulse_counts[i]){
+				*arg_params->out << " " << i << "=" << pulse_counts[i];
+			}
+		}
+		*arg_params->out << std::endl;
+	}
+
+	return mismatch_count == 0;
+}
+
+// ===========
+// Write plan
+// ===========
+
+// write_all merges several images into one and writes it as one plan in a session, a step per memory type
+
+// A S1 record of up to 255 - SREC_ADDR_CHECKSUM_COUNT bytes
+std::string get_srec_line(uint16_t arg_addr, const uint8_t *arg_data, uint32_t arg_len){
+	std::string srec_line;
+	uint8_t checksum = (uint8_t)(arg_len + SREC_ADDR_CHECKSUM_COUNT);
+	uint32_t i;
+
+	checksum += (arg_addr >> 8) & 0xff;
+	checksum += arg_addr & 0xff;
+	srec_line = "S1" + string_utils_ns::to_string_right_hex_up((uint16_t)(arg_len + SREC_ADDR_CHECKSUM_COUNT), 2, '0') + string_utils_ns::to_string_right_hex_up(arg_addr, 4, '0');
+	for(i = 0; i < arg_len; i++){
+		srec_line += string_utils_ns::to_string_right_hex_up((uint16_t)arg_data[i], 2, '0');
+		checksum += arg_data[i];
+	}
+
+	return srec_line + string_utils_ns::to_string_right_hex_up((uint16_t)(uint8_t)~checksum, 2, '0') + "\r\n";
+}
+
+// Plan step of an address by its memory type: RAM (with the registers, external memory and ROM, which the RAM write
+// check rejects), EEPROM, EPROM, then CONFIG as it only takes effect after a reset
+uint8_t get_plan_step(const mcu_profile *arg_profile, uint16_t arg_addr){
+	const mcu_region *region = mcu_profile_find_region(arg_profile, arg_addr);
+
+	if(region == NULL){
+		return PLAN_STEP_RAM;
+	}
+	switch(region->type){
+		case MEM_EEPROM:
+			return PLAN_STEP_EEPROM;
+		case MEM_EPROM:
+			return PLAN_STEP_EPROM;
+		case MEM_CONFIG:
+			return PLAN_STEP_CONFIG;
+		default:
+			return PLAN_STEP_RAM;
+	}
+}
+
+// Merge the files= images into one image, a common address of two files is rejected before anything is written.  The
+// image is split by the memory type of the MCU profile into the steps of the plan, each step's bytes are written to a
+// temporary S-record file for its write command.  See plan_remove()
+void plan_write(cl_my_params *arg_params, std::vector<plan_step> *arg_steps){
+	static const char *step_names[PLAN_STEP_COUNT] = { "RAM", "EEPROM", "EPROM", "CONFIG" };
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	std::vector<uint8_t> image(0x10000);
+	std::vector<int32_t> owners(0x10000, -1);  // The file of each address, -1 = none
+	cl_my_file in_file;
+	cl_my_file out_file;
+	std::string line_str;
+	std::string srec_line;
+	size_t bytes_written;
+	uint16_t srec_addr;
+	uint8_t srec_datacount;
+	uint16_t addr;
+	uint8_t step;
+	uint32_t len;
+	uint32_t i;
+	int32_t file_index;
+	plan_step plan;
+
+	if(profile == NULL){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MCU_NEEDED_ID, app_error_string::messages[APP_ERROR_MCU_NEEDED_ID], "write_all");
+	}
+	if(arg_params->file_names.empty()){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_PLAN_FILES_ID, app_error_string::messages[APP_ERROR_PLAN_FILES_ID], "");
+	}
+
+	for(file_index = 0; file_index < (int32_t)arg_params->file_names.size(); file_index++){
+		in_file.open_file(arg_params->file_names[file_index], "rb");
+		do{
+			line_str.clear();
+			in_file.read_file_line(line_str);
+			if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+				srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+				srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
+				for(i = 0; i < srec_datacount; i++){
+					addr = (uint16_t)(srec_addr + i);
+					if(owners[addr] >= 0 && owners[addr] != file_index){
+						throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_PLAN_OVERLAP_ID, std::format(app_error_string::messages[APP_ERROR_PLAN_OVERLAP_ID], arg_params->file_names[owners[addr]], arg_params->file_names[file_index], addr), "");
+					}
+					image[addr] = (uint8_t)strtoul(line_str.substr(8 + 2 * i, 2).c_str(), NULL, 16);
+					owners[addr] = file_index;
+				}
+			}
+		}while(!in_file.eof());
+		in_file.close_file();
+	}
+
+	for(step = 0; step < PLAN_STEP_COUNT; step++){
+		plan.name = step_names[step];
+		if(step == PLAN_STEP_EPROM){
+			plan.cmd = profile->eprom_cmd;
+		}else if(step == PLAN_STEP_RAM){
+			plan.cmd = CMD_WRITE_NORMAL;
+		}else{
+			plan.cmd = CMD_WRITE_EE;
+		}
+		plan.file_name.clear();
+		plan.byte_count = 0;
+
+		// S1 records of the step's runs of addresses
+		for(i = 0; i < 0x10000; i += len){
+			len = 0;
+			while(i + len < 0x10000 && len < arg_params->srec_datalen && owners[i + len] >= 0 && get_plan_step(profile, (uint16_t)(i + len)) == step){
+				len++;
+			}
+			if(len == 0){
+				len = 1;
+				continue;
+			}
+			if(plan.file_name.empty()){
+				plan.file_name = (std::filesystem::temp_directory_path() / std::format("tru11_plan_{}_{}.s19", std::chrono::steady_clock::now().time_since_epoch().count(), plan.name)).string();
+				arg_steps->push_back(plan);  // Removed by plan_remove() also when a later step fails
+				out_file.open_file(plan.file_name, "wb");
+				srec_line = "S0030000FC\r\n";
+				out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+			}
+			srec_line = get_srec_line((uint16_t)i, image.data() + i, len);
+			out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+			arg_steps->back().byte_count += len;
+		}
+		if(!plan.file_name.empty()){
+			srec_line = "S9030000FC\r\n";
+			out_file.write_file(srec_line.c_str(), srec_line.size(), bytes_written);
+			out_file.close_file();
+		}
+	}
+}
+
+// Remove the temporary files of the plan
+void plan_remove(std::vector<plan_step> *arg_steps){
+	std::error_code ec;
+
+	for(const plan_step &step : *arg_steps){
+		std::filesystem::remove(step.file_name, ec);
+	}
+	arg_steps->clear();
+}
+
+// ===========
+// Time model
+// ===========
+
+// Predicts the time of the transfer functions above for dryrun=y and the live ETA.  Each host write waits for tcdrain
+// and each reply wait costs the adapter latency, an echo overlaps its transmit except for the last byte, and programming
+// a byte takes the talker's delays
+
+// Bytes on the line
+void est_line(time_estimate *arg_est, uint32_t arg_baud, uint32_t arg_len){
+	arg_est->line_us += (uint64_t)arg_len * 10 * 1000000 / arg_baud;  // Start, 8 data and stop bits
+}
+
+// Transmit in blocks, see tx_chunk()
+void est_tx(cl_my_params *arg_params, time_estimate *arg_est, uint32_t arg_baud, uint32_t arg_len, uint32_t arg_bufsize){
+	est_line(arg_est, arg_baud, arg_len);
+	arg_est->wait_us += (uint64_t)((arg_len + arg_bufsize - 1) / arg_bufsize) * arg_params->latency_us;
+}
+
+// Receive, the blocks after the first arrive while the host reads
+void est_rx(cl_my_params *arg_params, time_estimate *arg_est, uint32_t arg_baud, uint32_t arg_len){
+	est_line(arg_est, arg_baud, arg_len);
+	arg_est->wait_us += arg_params->latency_us;
+}
+
+// Transmit and receive the echo in blocks, see txrx_chunk().  arg_prog_us is the programming time of each byte
+void est_txrx(cl_my_params *arg_params, time_estimate *arg_est, uint32_t arg_baud, uint32_t arg_len, uint32_t arg_bufsize, uint32_t arg_prog_us){
+	uint32_t blocks = (arg_len + arg_bufsize - 1) / arg_bufsize;
+
+	est_line(arg_est, arg_baud, arg_len + blocks);
+	arg_est->wait_us += (uint64_t)2 * blocks * arg_params->latency_us;
+	arg_est->prog_us += (uint64_t)arg_len * arg_prog_us;
+}
+
+// The talker's programming time of a byte
+uint32_t est_prog_us(uint8_t arg_write_cmd_code){
+	switch(arg_write_cmd_code){
+		case TALKER_WRITE_EE_CMD:
+			return 2 * TALKER_DELAY_US;  // Byte erase and program
+		case TALKER_WRITE_E_CMD:
+		case TALKER_WRITE_E20_CMD:
+			return TALKER_DELAY_US;
+		default:
+			return 0;
+	}
+}
+
+// See readmem_chunk(), a run-length encoded read is taken as a plain read
+void est_readmem_chunk(cl_my_params *arg_params, time_estimate *arg_est, uint32_t arg_len){
+	uint32_t baud = get_talker_baud(arg_params);
+
+	if(arg_params->use_frame){
+		// Framed header and reply for the read and its checksum command
+		est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+		est_tx(arg_params, arg_est, baud, FRAME_HEADER_LEN, arg_params->serial_txbuf_size);
+		est_rx(arg_params, arg_est, baud, 1 + arg_len);
+		est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+		est_tx(arg_params, arg_est, baud, FRAME_HEADER_LEN, arg_params->serial_txbuf_size);
+		est_rx(arg_params, arg_est, baud, 1 + 2);
+		return;
+	}
+
+	est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+	est_tx(arg_params, arg_est, baud, 3, arg_params->serial_txbuf_size);
+	est_rx(arg_params, arg_est, baud, arg_len);
+}
+
+// See writemem_chunk() and writemem_pulse_chunk()
+void est_writemem_chunk(cl_my_params *arg_params, time_estimate *arg_est, uint8_t arg_write_cmd_code, const uint8_t *arg_txbuf, uint32_t arg_len){
+	uint32_t baud = get_talker_baud(arg_params);
+	bool is_prog = arg_write_cmd_code != TALKER_WRITE_CMD;
+	uint32_t prog_us = est_prog_us(arg_write_cmd_code);
+	uint32_t i = 0;
+	uint32_t run;
+
+	arg_est->byte_count += arg_len;
+
+	// Adaptive EPROM pulses, taken as one pulse and its margin pulse per byte
+	if(arg_params->pulse_width && (arg_write_cmd_code == TALKER_WRITE_E_CMD || arg_write_cmd_code == TALKER_WRITE_E20_CMD)){
+		est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+		est_tx(arg_params, arg_est, baud, 6, arg_params->serial_txbuf_size);
+		est_tx(arg_params, arg_est, baud, arg_len, 1);
+		est_line(arg_est, baud, 2 * arg_len);
+		arg_est->wait_us += (uint64_t)arg_len * arg_params->latency_us;
+		arg_est->prog_us += (uint64_t)arg_len * 2 * arg_params->pulse_width * 100;
+		return;
+	}
+
+	// Write block command, each piece is sent at full line rate then programmed, taken as one piece per chunk
+	if(arg_params->use_block && is_prog){
+		est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+		est_rx(arg_params, arg_est, baud, 1);
+		est_tx(arg_params, arg_est, baud, 4, arg_params->serial_txbuf_size);
+		est_tx(arg_params, arg_est, baud, arg_len, arg_params->serial_txbuf_size);
+		arg_est->prog_us += (uint64_t)arg_len * prog_us;
+		est_rx(arg_params, arg_est, baud, 2);
+		return;
+	}
+
+	if(arg_params->use_frame && !arg_params->use_compress){
+		est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+		est_tx(arg_params, arg_est, baud, FRAME_HEADER_LEN, arg_params->serial_txbuf_size);
+		est_rx(arg_params, arg_est, baud, 1);
+	}else{
+		est_txrx(arg_params, arg_est, baud, 1, 1, 0);
+		est_tx(arg_params, arg_est, baud, arg_params->use_compress ? 4 : 3, arg_params->serial_txbuf_size);
+	}
+
+	// Runs as txrx_rle_chunk_write() sends them, each run's reply waits for its programming
+	if(arg_params->use_compress){
+		while(i < arg_len){
+			run = 1;
+			while(i + run < arg_len && run < 257 && arg_txbuf[i + run] == arg_txbuf[i]){
+				run++;
+			}
+			est_tx(arg_params, arg_est, baud, 1, 1);
+			if(is_prog){
+				est_rx(arg_params, arg_est, baud, 1);
+				arg_est->prog_us += prog_us;
+			}
+			if(run >= 2){
+				est_tx(arg_params, arg_est, baud, 2, 1);
+				est_rx(arg_params, arg_est, baud, 1);
+				arg_est->prog_us += (uint64_t)(run - 1) * prog_us;
+			}
+			i += run;
+		}
+		est_rx(arg_params, arg_est, baud, 2);
+		return;
+	}
+
+	est_txrx(arg_params, arg_est, baud, arg_len, is_prog ? arg_params->serial_prog_txbuf_size : arg_params->serial_txbuf_size, prog_us);
+}
+
+// See upload_talker(), without ping=y and the MCU detection
+void est_upload_talker(cl_my_params *arg_params, time_estimate *arg_est){
+	uint32_t boot_baud = get_boot_baud(arg_params, arg_params->use_fast ? 7618 : 1200);
+	uint32_t talker_len = get_srec_data_count(arg_params->talker_filename);
+	uint32_t len = (arg_params->loader_filename.size() > 0) ? get_srec_data_count(arg_params->loader_filename) : talker_len;
+	uint32_t baud = get_talker_baud(arg_params);
+
+	// The sync char and the bootloader's echoes
+	est_tx(arg_params, arg_est, boot_baud, 1, 1);
+	est_txrx(arg_params, arg_est, boot_baud, (arg_params->ram_size == BOOTLOADER_MAX_BYTE_COUNT) ? BOOTLOADER_MAX_BYTE_COUNT : len, arg_params->serial_txbuf_size, 0);
+	arg_est->byte_count += talker_len;
+
+	if(arg_params->loader_filename.size() > 0){
+		est_tx(arg_params, arg_est, baud, 4, arg_params->serial_txbuf_size);
+		est_txrx(arg_params, arg_est, baud, talker_len, arg_params->serial_txbuf_size, 0);
+	}
+
+	// Ping
+	est_tx(arg_params, arg_est, baud, 1, 1);
+	est_rx(arg_params, arg_est, baud, 3);
+}
+
+// Predict the time of the command in arg_params without the serial COM port.  Sync reads are taken as full reads and
+// run-length encoded reads as plain reads
+void estimate_cmd(cl_my_params *arg_params, time_estimate *arg_est){
+	const mcu_profile *profile = mcu_profile_find(arg_params->mcu_name);
+	cl_my_file in_file;
+	std::string line_str;
+	uint8_t srec_datacount;
+	uint16_t srec_addr;
+	std::vector<uint8_t> block;
+	uint16_t block_addr = 0;
+	uint32_t chunklen;
+	uint32_t addr;
+	uint32_t i;
+	uint8_t write_cmd_code;
+
+	*arg_est = {};
+	if(arg_params->ram_size == 0){
+		arg_params->ram_size = (profile != NULL) ? profile->ram_size : BOOTLOADER_MAX_BYTE_COUNT;
+	}
+
+	switch(arg_params->cmd){
+		case CMD_UPTALKER:
+			est_upload_talker(arg_params, arg_est);
+			break;
+		case CMD_READ:
+			if(arg_params->use_all && profile != NULL){
+				for(i = 0; i < profile->region_count; i++){
+					if(profile->regions[i].is_read_all){
+						for(addr = profile->regions[i].start_addr; addr <= profile->regions[i].end_addr; addr += chunklen){
+							chunklen = get_chunk_len(profile, (uint16_t)addr, (uint32_t)profile->regions[i].end_addr - addr + 1);
+							est_readmem_chunk(arg_params, arg_est, chunklen);
+							arg_est->byte_count += chunklen;
+						}
+					}
+				}
+			}else{
+				for(addr = arg_params->from_addr; addr <= arg_params->to_addr; addr += chunklen){
+					chunklen = get_chunk_len(profile, (uint16_t)addr, arg_params->to_addr - addr + 1);
+					est_readmem_chunk(arg_params, arg_est, chunklen);
+					arg_est->byte_count += chunklen;
+				}
+			}
+			break;
+		case CMD_READ_VERIFY:
+			in_file.open_file(arg_params->full_file_name, "rb");
+			do{
+				line_str.clear();
+				in_file.read_file_line(line_str);
+				if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+					srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+					est_readmem_chunk(arg_params, arg_est, srec_datacount);
+					arg_est->byte_count += srec_datacount;
+				}
+			}while(!in_file.eof());
+			break;
+		case CMD_WRITE_NORMAL_HEXSTR:
+		case CMD_WRITE_EE_HEXSTR:
+			write_cmd_code = (arg_params->cmd == CMD_WRITE_EE_HEXSTR) ? TALKER_WRITE_EE_CMD : TALKER_WRITE_CMD;
+			for(i = 0; i + 1 < arg_params->data.size(); i += 2){
+				block.push_back((uint8_t)strtoul(arg_params->data.substr(i, 2).c_str(), NULL, 16));
+			}
+			for(i = 0; i < block.size(); i += chunklen){
+				chunklen = ((uint32_t)block.size() - i > TALKER_MAX_BYTE_COUNT) ? TALKER_MAX_BYTE_COUNT : (uint32_t)block.size() - i;
+				est_writemem_chunk(arg_params, arg_est, write_cmd_code, block.data() + i, chunklen);
+			}
+			break;
+		case CMD_WRITE_NORMAL:
+		case CMD_WRITE_EE:
+		case CMD_WRITE_E:
+		case CMD_WRITE_E20:
+			write_cmd_code = (arg_params->cmd == CMD_WRITE_EE) ? TALKER_WRITE_EE_CMD : (arg_params->cmd == CMD_WRITE_E) ? TALKER_WRITE_E_CMD : (arg_params->cmd == CMD_WRITE_E20) ? TALKER_WRITE_E20_CMD : TALKER_WRITE_CMD;
+
+			// The same blocks as writemem_file()
+			in_file.open_file(arg_params->full_file_name, "rb");
+			do{
+				line_str.clear();
+				in_file.read_file_line(line_str);
+				if(line_str.size() >= 8 && line_str.substr(0, 2) == "S1"){
+					srec_datacount = (uint8_t)strtoul(line_str.substr(2, 2).c_str(), NULL, 16) - SREC_ADDR_CHECKSUM_COUNT;
+					srec_addr = (uint16_t)strtoul(line_str.substr(4, 4).c_str(), NULL, 16);
+					if(block.size() && ((!arg_params->use_compress && !arg_params->use_block) || (uint16_t)(block_addr + block.size()) != srec_addr || block.size() + srec_datacount > get_chunk_len(profile, block_addr, 0x10000))){
+						est_writemem_chunk(arg_params, arg_est, write_cmd_code, block.data(), (uint32_t)block.size());
+						block.clear();
+					}
+					if(block.empty()){
+						block_addr = srec_addr;
+					}
+					for(i = 0; i < srec_datacount; i++){
+						block.push_back((uint8_t)strtoul(line_str.substr(2 * i + 8, 2).c_str(), NULL, 16));
+					}
+				}
+			}while(!in_file.eof());
+			if(block.size()){
+				est_writemem_chunk(arg_params, arg_est, write_cmd_code, block.data(), (uint32_t)block.size());
+			}
+			break;
+		default:
+			break;
+	}
+
+	// Multi-drop, each other unit is verified on its own
+	if(arg_params->units.size() > 1 && (arg_params->cmd == CMD_READ_VERIFY || arg_params->cmd == CMD_WRITE_NORMAL || arg_params->cmd == CMD_WRITE_EE || arg_params->cmd == CMD_WRITE_E || arg_params->cmd == CMD_WRITE_E20)){
+		cl_my_params unit_params = *arg_params;
+		time_estimate unit_est;
+
+		unit_params.cmd = CMD_READ_VERIFY;
+		unit_params.units.clear();
+		estimate_cmd(&unit_params, &unit_est);
+		arg_est->line_us += unit_est.line_us * (arg_params->units.size() - 1);
+		arg_est->wait_us += unit_est.wait_us * (arg_params->units.size() - 1);
+	}
+}
+
+// Show an estimate, e.g. "12.3s"
+std::string est_time_str(uint64_t arg_us){
+	return std::format("{:.1f}s", arg_us / 1000000.0);
+}
+
+void print_estimate(cl_my_params *arg_params, time_estimate *arg_est){
+	*arg_params->out << "Estimate " << est_time_str(arg_est->line_us + arg_est->wait_us + arg_est->prog_us) << " for " << arg_est->byte_count << " bytes: line " << est_time_str(arg_est->line_us) << ", adapter waits " << est_time_str(arg_est->wait_us) << ", programming " << est_time_str(arg_est->prog_us) << std::endl;
+}
+
+// Detect the MCU and apply its profile, except for the upload which is before the talker is running
+void apply_mcu_profile(cl_my_params *arg_params, serial_com *arg_serial_com){
+	const mcu_profile *profile = NULL;
+
+	if(arg_params->mcu_name == MCU_PROFILE_AUTO && arg_params->cmd != CMD_UPTALKER && arg_params->cmd != CMD_NONE){
+		detect_mcu(arg_params, arg_serial_com);
+	}
+
+	if(arg_params->mcu_name.size() > 0 && arg_params->mcu_name != MCU_PROFILE_AUTO){
+		profile = mcu_profile_find(arg_params->mcu_name);
+		if(profile == NULL){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MCU_ID, std::format(app_error_string::messages[APP_ERROR_MCU_ID], arg_params->mcu_name, mcu_profile_names()), "");
+		}
+	}
+	if(arg_params->ram_size == 0){
+		arg_params->ram_size = (profile != NULL) ? profile->ram_size : BOOTLOADER_MAX_BYTE_COUNT;
+	}
+	if(arg_params->use_frame && arg_params->ram_size <= 512){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_FRAME_RAM_ID, app_error_string::messages[APP_ERROR_FRAME_RAM_ID], "");
+	}
+
+	// write_e and write_e20 both mean program the EPROM of the MCU
+	if(profile != NULL && profile->eprom_cmd != CMD_NONE && (arg_params->cmd == CMD_WRITE_E || arg_params->cmd == CMD_WRITE_E20) && arg_params->cmd != profile->eprom_cmd){
+		*arg_params->out << "Using " << ((profile->eprom_cmd == CMD_WRITE_E20) ? "write_e20" : "write_e") << " for the " << profile->name << std::endl;
+		arg_params->cmd = profile->eprom_cmd;
+	}
+}
+
+// Multi-drop, true for the commands broadcast to all the units
+bool is_mdrop_broadcast(cl_my_params *arg_params){
+	switch(arg_params->cmd){
+		case CMD_WRITE_NORMAL_HEXSTR:
+		case CMD_WRITE_EE_HEXSTR:
+		case CMD_WRITE_NORMAL:
+		case CMD_WRITE_EE:
+		case CMD_WRITE_E:
+		case CMD_WRITE_E20:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Multi-drop, send an address byte with the ninth bit set as mark parity.  The port is left with space parity for the
+// bytes that follow
+void mdrop_address(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_addr){
+	arg_serial_com->set_parity(MARKPARITY);
+	tx_chunk(arg_params, arg_serial_com, &arg_addr, 1);
+	arg_serial_com->set_parity(SPACEPARITY);
+}
+
+// Multi-drop, switch the talkers on the line to multi-drop with their unit addresses read from unit_addr=, check each
+// of the units= replies, then select them for the command.  A write is broadcast to all the units with the first one
+// replying, any other command goes to the first unit
+void mdrop_begin(cl_my_params *arg_params, serial_com *arg_serial_com){
+	uint8_t txbuf[3];
+	uint8_t rxbyte;
+	std::string missing;
+	size_t missing_count = 0;
+
+	for(uint8_t unit : arg_params->units){
+		if(unit == MDROP_ADDR_BROADCAST || unit == MDROP_ADDR_EXIT){
+			throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MDROP_UNITS_ID, std::format(app_error_string::messages[APP_ERROR_MDROP_UNITS_ID], unit), "");
+		}
+	}
+
+	// Talkers still in multi-drop leave it, the others take the address as an identify command
+	arg_serial_com->set_params(get_talker_baud(arg_params), 8, NOPARITY, ONESTOPBIT, false);
+	mdrop_address(arg_params, arg_serial_com, MDROP_ADDR_EXIT);
+	arg_serial_com->set_parity(NOPARITY);
+#if defined(WIN32) || defined(WIN64)
+	Sleep(MDROP_RESET_MS);
+#else
+	usleep(MDROP_RESET_MS * 1000);
+#endif
+	arg_serial_com->purge();
+
+	// All the talkers reply with the same echo
+	txbuf[0] = TALKER_MDROP_CMD;
+	try{
+		txrx_chunk(arg_params, arg_serial_com, txbuf, &rxbyte, 1, true);
+	}catch(tru_exception &ex){
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MDROP_ID, app_error_string::messages[APP_ERROR_MDROP_ID], ex.get_message());
+	}
+	txbuf[0] = 0;  // Byte count, not used
+	txbuf[1] = (uint8_t)(arg_params->unit_addr >> 8 & 0xff);
+	txbuf[2] = (uint8_t)(arg_params->unit_addr & 0xff);
+	tx_chunk(arg_params, arg_serial_com, txbuf, 3);
+	arg_serial_com->set_parity(SPACEPARITY);
+
+	// A purge after the address could discard it before it is sent
+	for(uint8_t unit : arg_params->units){
+		arg_serial_com->purge();
+		mdrop_address(arg_params, arg_serial_com, unit);
+		*arg_params->out << "Unit " << (uint16_t)unit << ": ";
+		if(!identify_talker(arg_params, arg_serial_com)){
+			*arg_params->out << "no reply" << std::endl;
+			missing += (missing.empty() ? "" : ", ") + std::to_string(unit);
+			missing_count++;
+		}
+	}
+	if(missing.size() > 0){
+		// Leave multi-drop so that the replying talkers take commands again
+		mdrop_address(arg_params, arg_serial_com, MDROP_ADDR_EXIT);
+		arg_serial_com->set_parity(NOPARITY);
+		throw tru_exception(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_MDROP_UNIT_ID, std::format(app_error_string::messages[APP_ERROR_MDROP_UNIT_ID], missing), missing_count == arg_params->units.size() ? app_error_string::messages[APP_ERROR_MDROP_ID] : "");
+	}
+
+	if(is_mdrop_broadcast(arg_params)){
+		mdrop_address(arg_params, arg_serial_com, MDROP_ADDR_BROADCAST);
+		tx_chunk(arg_params, arg_serial_com, &arg_params->units[0], 1);  // Lead unit
+		*arg_params->out << "Broadcasting to " << arg_params->units.size() << " unit(s), unit " << (uint16_t)arg_params->units[0] << " replies" << std::endl;
+	}else{
+		mdrop_address(arg_params, arg_serial_com, arg_params->units[0]);
+	}
+}
+
+// Multi-drop, after a write or verify of the first unit verify each of the others, then return the talkers to 8 data
+// bits.  Returns false when the command or a unit failed
+bool mdrop_end(cl_my_params *arg_params, serial_com *arg_serial_com, bool arg_is_passed){
+	std::string failed;
+	size_t i;
+
+	if(arg_is_passed && arg_params->full_file_name.size() > 0 && (arg_params->cmd == CMD_READ_VERIFY || arg_params->cmd == CMD_WRITE_NORMAL || arg_params->cmd == CMD_WRITE_EE || arg_params->cmd == CMD_WRITE_E || arg_params->cmd == CMD_WRITE_E20)){
+		for(i = 1; i < arg_params->units.size(); i++){
+			*arg_params->out << std::endl << "Verifying unit " << (uint16_t)arg_params->units[i] << std::endl;
+			mdrop_address(arg_params, arg_serial_com, arg_params->units[i]);
+			if(!readmem_verify(arg_params, arg_serial_com)){
+				failed += (failed.empty() ? "" : ", ") + std::to_string(arg_params->units[i]);
+			}
+		}
+		if(failed.size() > 0){
+			*arg_params->out << std::endl << "Unit(s) " << failed << " FAILED" << std::endl;
+			arg_is_passed = false;
+		}
+	}
+
+	mdrop_address(arg_params, arg_serial_com, MDROP_ADDR_EXIT);
+	arg_serial_com->set_parity(NOPARITY);
+
+	return arg_is_passed;
+}
+
+// Download the talker with the bootloader, or with ping=y skip it when the talker is already running
+void upload_talker(cl_my_params *arg_params, serial_com *arg_serial_com){
+	if(arg_params->use_ping){
+		arg_serial_com->set_params(get_talker_baud(arg_params), 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
+		if(ping_talker(arg_params, arg_serial_com)){
+			*arg_params->out << "Download skipped" << std::endl;
+			return;
+		}
+	}
+
+	if(arg_params->use_fast){
+		arg_serial_com->set_params(get_boot_baud(arg_params, 7618), 8, NOPARITY, ONESTOPBIT, false);  // Set to bootloader ROM port settings
+	}else{
+		arg_serial_com->set_params(get_boot_baud(arg_params, 1200), 8, NOPARITY, ONESTOPBIT, false);  // Set to bootloader ROM port settings
+	}
+
+	send_control_program(arg_params, arg_serial_com);  // Download custom EEPROM control program to MCU RAM
+	*arg_params->out << "Download completed successfully" << std::endl;
+
+	arg_serial_com->set_params(get_talker_baud(arg_params), 8, NOPARITY, ONESTOPBIT, false);  // Set to talker port settings
+
+	// Two-stage boot, send the talker to the loader
+	if(arg_params->loader_filename.size() > 0){
+		// The loader does not reply until it is sent the talker, so we need to wait a bit for the bootloader to jump to it
+#if defined(WIN32) || defined(WIN64)
+		Sleep(75);
+#else
+		usleep(75000);
+#endif
+		send_talker_stage2(arg_params, arg_serial_com);
+		*arg_params->out << "Talker download completed successfully" << std::endl;
+	}
+
+	wait_talker_ready(arg_params, arg_serial_com);
+	if(arg_params->mcu_name == MCU_PROFILE_AUTO){
+		detect_mcu(arg_params, arg_serial_com);
+	}
+}
+
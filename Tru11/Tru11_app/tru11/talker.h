@@ -0,0 +1,137 @@
+#ifndef TALKER_H
+#define TALKER_H
+
+#include "cmd_line.h"
+#include "serial_com.h"
+#include "tru_exception.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BOOTLOADER_MAX_BYTE_COUNT 256
+#define LOADER_MAX_BYTE_COUNT     0x10000
+#define LOADER_RESERVED_BYTE_COUNT 59  // Loader load loop, end address and stack at the top of RAM
+#define LOADER_BAUD_VAL_ADDR      0x0001  // Loader timing parameter, see the loader
+#define TALKER_MAX_BYTE_COUNT     256
+#define TALKER_READ_CMD           0x01
+#define TALKER_WRITE_CMD          0x02
+#define TALKER_WRITE_EE_CMD       0x03
+#define TALKER_WRITE_E_CMD        0x04
+#define TALKER_WRITE_E20_CMD      0x05
+#define TALKER_READ_RLE_CMD       0x06
+#define TALKER_WRITE_RLE_CMD      0x07
+#define TALKER_WRITE_E_PULSE_CMD  0x08
+#define TALKER_WRITE_BLOCK_CMD    0x09
+#define TALKER_SUM_CMD            0x0a
+#define TALKER_FRAME_CMD          0x0b
+#define TALKER_MDROP_CMD          0x0c
+#define TALKER_CALL_CMD           0x0d
+#define TALKER_IDENT_CMD          0xff
+#define TALKER_PING_TIMEOUT_MS    100
+#define TALKER_PROG_DELAY_MS      20  // Talker worst case delay for programming a byte (EEPROM erase + program)
+#define TALKER_DELAY_US           10000  // Talker programming delay, DelayCnt is patched for the crystal
+#define TALKER_RESYNC_PARAM_BYTE  0x10  // Resync filler for command parameters, as a byte count and address it is $1010
+#define TALKER_RESYNC_PARAM_COUNT 8
+#define TALKER_RESYNC_MAX_PINGS   300  // More than a whole chunk, each ping may be taken as a data byte
+#define TALKER_BLOCK_STACK_LEN    16  // Stack space at the top of RAM, BlockStack of the talker
+#define SCAN_OPT_WRITE            0x01  // Scan routine options, write the value after each byte is read
+#define SCAN_OPT_ANY              0x40  // Any value read is expected
+#define SCAN_OPT_DOWN             0x80  // Descending addresses
+#define SCAN_MAX_LEN              0x2000  // 8KB per call of the scan routine, at 27 E cycles a byte about 0.1s with an 8MHz crystal
+#define SCAN_EXPECTED_OFS         5  // Patched operands and opcodes of the scan routine, see scan_routine[]
+#define SCAN_BRANCH_OFS           6
+#define SCAN_VALUE_OFS            9
+#define SCAN_STORE_OFS            11
+#define SCAN_STEP_OFS             14
+#define MEMTEST_MAX_FAILS         16
+#define FRAME_HEADER_LEN          7  // Sequence number, command, byte count, address and CRC-16
+#define FRAME_MAX_RETRIES         8
+#define TALKER_DELAY_CNT_ADDR     0x0002  // Talker timing parameters, see the talker
+#define TALKER_BAUD_VAL_ADDR      0x000d
+#define TALKER_PULSE_CNT_ADDR     0x001a  // RAM size more than 256 bytes only
+#define XTAL_DEFAULT_HZ           8000000  // The bootloader baud rates, the talker and the loader are for an 8MHz crystal
+#define BAUD_MAX_ERROR_PERCENT    2
+#define SREC_ADDR_CHECKSUM_COUNT  3
+#define SYNC_SUB_BLOCK_LEN        16  // Checksummed again when a block's checksum does not match
+#define HC11_CONFIG_ADDR          0x103f
+#define HC11_REG_ADDR             0x1000
+#define HC11_REG_LEN              0x40
+#define HC11_BAUD_DEFAULT         0x30  // Prescaler 13, 9615 baud with an 8MHz crystal
+#define HC11_BAUD_ADDR            0x102b
+#define HC11_PORTE_ADDR           0x100a
+#define HC11_CONFIG_ROMON_BIT     0x02
+#define HC11_CONFIG_EE_BITS       0xf0  // 811E2 EEPROM block select
+#define HC11_EPROG_ADDR           0x1036  // 711E20 only
+#define HC11_PPROG_ADDR           0x103b
+#define HC11_ELAT_BIT             0x20  // EPROM latch in EPROG (711E20) or PPROG (711E9)
+#define HC11_OP_BRN               0x21
+#define HC11_OP_CMPA_IND          0xa1  // After the $18 prefix it is CMPA $00,Y
+#define HC11_OP_DEY               0x09  // After the $18 prefix
+#define MDROP_ADDR_BROADCAST      0x00  // Followed by the lead unit, see the talker multi-drop command
+#define MDROP_ADDR_EXIT           0xff
+#define MDROP_RESET_MS            50  // Talkers not in multi-drop take the reset as an identify command and reply
+#define MCU_PROBE_RAM_OFS         0x80  // RAM probe offset into each 256 bytes
+#define MCU_PROBE_DECOY_OFS       0x40
+#define JOURNAL_HEADER            "tru11 journal "
+#define PLAN_STEP_RAM             0  // write_all steps in the order they are written, see plan_write()
+#define PLAN_STEP_EEPROM          1
+#define PLAN_STEP_EPROM           2
+#define PLAN_STEP_CONFIG          3
+#define PLAN_STEP_COUNT           4
+#define JOURNAL_REGION_COUNT      (MCU_MAX_REGION_COUNT + 1)  // The MCU profile regions, the last is for unmapped addresses or no profile
+
+// Registers passed to and returned from a routine called with the talker call command
+typedef struct{
+	uint8_t a;
+	uint8_t b;
+	uint16_t y;
+}talker_regs;
+
+// A step of the write_all plan, one memory type of the merged image
+typedef struct{
+	unsigned char cmd;  // CMD_WRITE_NORMAL, CMD_WRITE_EE, CMD_WRITE_E or CMD_WRITE_E20
+	std::string name;
+	std::string file_name;  // Temporary S-record file of the step's bytes
+	uint32_t byte_count;
+}plan_step;
+
+// Predicted time of a command, see estimate_cmd()
+typedef struct{
+	uint64_t line_us;  // Bytes on the serial line
+	uint64_t wait_us;  // Adapter latency of each write (tcdrain) and reply wait
+	uint64_t prog_us;  // Talker programming delays
+	uint32_t byte_count;  // Bytes of the image, range or talker
+}time_estimate;
+
+// The talker session, the read, verify and write paths of the command line program.  Output goes to arg_params->out,
+// see cl_my_params for the progress, mismatch and read buffer hooks
+uint32_t get_talker_baud(cl_my_params *arg_params);
+void set_talker_port(cl_my_params *arg_params, serial_com *arg_serial_com);
+void mdrop_begin(cl_my_params *arg_params, serial_com *arg_serial_com);
+bool mdrop_end(cl_my_params *arg_params, serial_com *arg_serial_com, bool arg_is_passed);
+void print_line_errors(cl_my_params *arg_params, serial_com *arg_serial_com, serial_line_errors *arg_before);
+bool fallback_baud(cl_my_params *arg_params, serial_com *arg_serial_com, tru_exception *arg_ex, uint32_t arg_error_mark);
+bool ping_talker(cl_my_params *arg_params, serial_com *arg_serial_com);
+void resync_talker(cl_my_params *arg_params, serial_com *arg_serial_com, bool arg_is_param);
+void readmem_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint16_t arg_addr, uint8_t *arg_rxbuf, uint32_t arg_len);
+void writemem_chunk(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code, uint16_t arg_addr, uint8_t *arg_txbuf, uint8_t *arg_rxbuf, uint32_t arg_len);
+void detect_mcu(cl_my_params *arg_params, serial_com *arg_serial_com);
+void apply_mcu_profile(cl_my_params *arg_params, serial_com *arg_serial_com);
+void upload_talker(cl_my_params *arg_params, serial_com *arg_serial_com);
+void readmem(cl_my_params *arg_params, serial_com *arg_serial_com);
+bool readmem_verify(cl_my_params *arg_params, serial_com *arg_serial_com);
+bool blank_check(cl_my_params *arg_params, serial_com *arg_serial_com);
+void check_memtest(cl_my_params *arg_params);
+bool memtest(cl_my_params *arg_params, serial_com *arg_serial_com);
+void check_call(cl_my_params *arg_params);
+void call_routine(cl_my_params *arg_params, serial_com *arg_serial_com, talker_regs *arg_regs);
+void check_write(cl_my_params *arg_params, uint8_t arg_write_cmd_code);
+void plan_write(cl_my_params *arg_params, std::vector<plan_step> *arg_steps);
+void plan_remove(std::vector<plan_step> *arg_steps);
+void estimate_cmd(cl_my_params *arg_params, time_estimate *arg_est);
+std::string est_time_str(uint64_t arg_us);
+void print_estimate(cl_my_params *arg_params, time_estimate *arg_est);
+void writemem_hexstr(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code);
+bool writemem_file(cl_my_params *arg_params, serial_com *arg_serial_com, uint8_t arg_write_cmd_code);
+
+#endif
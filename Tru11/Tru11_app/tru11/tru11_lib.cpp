@@ -0,0 +1,294 @@
+#include "tru11_lib.h"
+#include "app_error_string.h"
+#include "tru_exception.h"
+#include "talker.h"
+#include "mcu_profile.h"
+#include <sstream>
+#include <chrono>
+#include <format>
+
+// Run a command with the serial COM port open and the MCU profile applied, the command line program and the sessions
+// both run their commands with it.  arg_confirm asks for the programming confirmation of a write, when it is empty the
+// write is confirmed.  The registers a called routine returns with go to arg_regs
+// Returns false when a verify failed or the confirmation was declined
+bool run_talker_cmd(cl_my_params *arg_params, serial_com *arg_serial_com, std::function<bool(uint8_t arg_write_cmd_code)> arg_confirm, talker_regs *arg_regs){
+	bool is_passed = true;
+
+	switch(arg_params->cmd){
+		case CMD_UPTALKER:
+			upload_talker(arg_params, arg_serial_com);
+
+			break;
+		case CMD_READ:
+			set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+			*arg_params->out << "Reading memory" << std::endl;
+			readmem(arg_params, arg_serial_com);
+
+			break;
+		case CMD_READ_VERIFY:
+			set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+			*arg_params->out << "Reading & verifying memory" << std::endl;
+			is_passed = readmem_verify(arg_params, arg_serial_com);
+
+			break;
+		case CMD_BLANK_CHECK:
+			set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+			is_passed = blank_check(arg_params, arg_serial_com);
+
+			break;
+		case CMD_MEMTEST:
+			check_memtest(arg_params);
+			is_passed = !arg_params->use_ee || !arg_confirm || arg_confirm(TALKER_WRITE_EE_CMD);
+			if(is_passed){
+				set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+				is_passed = memtest(arg_params, arg_serial_com);
+			}
+
+			break;
+		case CMD_CALL:
+			check_call(arg_params);
+			set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+			call_routine(arg_params, arg_serial_com, arg_regs);
+
+			break;
+		case CMD_WRITE_NORMAL_HEXSTR:
+			check_write(arg_params, TALKER_WRITE_CMD);
+			set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+			*arg_params->out << "Writing normal memory" << std::endl;
+			writemem_hexstr(arg_params, arg_serial_com, TALKER_WRITE_CMD);
+
+			break;
+		case CMD_WRITE_EE_HEXSTR:
+			check_write(arg_params, TALKER_WRITE_EE_CMD);
+			is_passed = !arg_confirm || arg_confirm(TALKER_WRITE_EE_CMD);
+			if(is_passed){
+				set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+				*arg_params->out << "Writing EEPROM" << std::endl;
+				writemem_hexstr(arg_params, arg_serial_com, TALKER_WRITE_EE_CMD);
+			}
+
+			break;
+		case CMD_WRITE_NORMAL:
+			check_write(arg_params, TALKER_WRITE_CMD);
+			set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+			*arg_params->out << "Writing & verifying normal memory" << std::endl;
+			is_passed = writemem_file(arg_params, arg_serial_com, TALKER_WRITE_CMD);
+
+			break;
+		case CMD_WRITE_EE:
+			check_write(arg_params, TALKER_WRITE_EE_CMD);
+			is_passed = !arg_confirm || arg_confirm(TALKER_WRITE_EE_CMD);
+			if(is_passed){
+				set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+				*arg_params->out << "Writing & verifying EEPROM" << std::endl;
+				is_passed = writemem_file(arg_params, arg_serial_com, TALKER_WRITE_EE_CMD);
+			}
+
+			break;
+		case CMD_WRITE_E:
+			check_write(arg_params, TALKER_WRITE_E_CMD);
+			is_passed = !arg_confirm || arg_confirm(TALKER_WRITE_E_CMD);
+			if(is_passed){
+				set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+				*arg_params->out << "Writing & verifying EPROM (non E20)" << std::endl;
+				is_passed = writemem_file(arg_params, arg_serial_com, TALKER_WRITE_E_CMD);
+				*arg_params->out << "Please remove programming voltage (12V) now before powering of the MCU" << std::endl;
+			}
+
+			break;
+		case CMD_WRITE_E20:
+			check_write(arg_params, TALKER_WRITE_E20_CMD);
+			is_passed = !arg_confirm || arg_confirm(TALKER_WRITE_E20_CMD);
+			if(is_passed){
+				set_talker_port(arg_params, arg_serial_com);  // Set to talker port settings
+				*arg_params->out << "Writing & verifying EPROM (E20, 12V)" << std::endl;
+				is_passed = writemem_file(arg_params, arg_serial_com, TALKER_WRITE_E20_CMD);
+				*arg_params->out << "Please remove programming voltage (12V) now before powering of the MCU" << std::endl;
+			}
+
+			break;
+		default:
+			break;
+	}
+
+	return is_passed;
+}
+
+void tru11_session::open(std::string arg_dev_path){
+	params.dev_path = arg_dev_path;
+	_serial.open_handle(params.dev_path);  // Open serial COM port
+	_serial.set_timeout(params.timeoutms);  // Set serial COM port timeout
+	_serial.purge();  // Clear buffer
+}
+
+void tru11_session::close(){
+	_serial.close_handle();
+}
+
+// The result of a call that stopped at an error
+void set_result_error(tru11_result *arg_result, tru_exception &arg_ex){
+	arg_result->is_passed = false;
+	arg_result->error_code = arg_ex.get_code();
+	arg_result->error = arg_ex.get_error();
+}
+
+// Checks the arg_len bytes from arg_addr are within the 64KB memory map, else the result gets the error
+bool tru11_session::check_range(uint16_t arg_addr, uint32_t arg_len, tru11_result *arg_result){
+	if(arg_len == 0 || (uint32_t)arg_addr + arg_len > 0x10000){
+		tru_exception ex(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_SESSION_RANGE_ID, std::format(app_error_string::messages[APP_ERROR_SESSION_RANGE_ID], arg_len, arg_addr), "");
+		set_result_error(arg_result, ex);
+		return false;
+	}
+
+	return true;
+}
+
+// Run a command with a copy of the session parameters, as a job step.  The output, mismatches, read bytes and the
+// elapsed time go to the result, also when the command stops at an error
+void tru11_session::run(cmd_type arg_cmd, cl_my_params *arg_call_params, tru11_result *arg_result){
+	std::ostringstream out_stream;
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	bool is_detect;
+	bool is_mdrop;
+	time_estimate est;
+
+	arg_call_params->cmd = arg_cmd;
+	arg_call_params->out = &out_stream;
+	arg_call_params->on_progress = on_progress;
+	arg_call_params->mismatches = &arg_result->mismatches;
+	arg_call_params->read_buf = &arg_result->bytes;
+	arg_result->is_passed = true;
+	arg_result->error_code = 0;
+
+	_serial.set_timeout(arg_call_params->timeoutms);
+	is_detect = (arg_call_params->mcu_name == MCU_PROFILE_AUTO);
+	is_mdrop = !arg_call_params->units.empty() && arg_cmd != CMD_UPTALKER;
+	try{
+		if(is_mdrop){
+			mdrop_begin(arg_call_params, &_serial);
+		}
+		apply_mcu_profile(arg_call_params, &_serial);
+		estimate_cmd(arg_call_params, &est);
+		arg_result->estimate_ms = (uint32_t)((est.line_us + est.wait_us + est.prog_us) / 1000);
+
+		arg_result->is_passed = run_talker_cmd(arg_call_params, &_serial, nullptr, &arg_result->regs);
+		if(is_mdrop){
+			arg_result->is_passed = mdrop_end(arg_call_params, &_serial, arg_result->is_passed);
+		}
+		if(is_detect){
+			params.mcu_name = arg_call_params->mcu_name;  // Keep a detected MCU for the next calls
+		}
+		params.max_baud = arg_call_params->max_baud;  // Keep a lowered baud rate, the talker runs at it
+		params.frame_seq = arg_call_params->frame_seq;
+	}catch(tru_exception &ex){
+		_serial.purge();  // Clear any bytes left from the failed command for the next call
+		set_result_error(arg_result, ex);
+	}
+
+	arg_result->elapsed_ms = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+	arg_result->log = out_stream.str();
+}
+
+tru11_result tru11_session::upload_talker(){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	run(CMD_UPTALKER, &call_params, &result);
+
+	return result;
+}
+
+// Returns the bytes from arg_addr, result.bytes
+tru11_result tru11_session::read(uint16_t arg_addr, uint32_t arg_len){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	if(!check_range(arg_addr, arg_len, &result)){
+		return result;
+	}
+	call_params.from_addr = arg_addr;
+	call_params.to_addr = arg_addr + arg_len - 1;
+	call_params.use_all = false;
+	call_params.full_file_name.clear();
+	result.bytes.reserve(arg_len);
+	run(CMD_READ, &call_params, &result);
+
+	return result;
+}
+
+// Compares memory with a S-record file
+tru11_result tru11_session::verify(std::string arg_file_name){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	call_params.full_file_name = arg_file_name;
+	run(CMD_READ_VERIFY, &call_params, &result);
+
+	return result;
+}
+
+// Checks memory from arg_addr is erased ($ff), the first byte that is not is the one mismatch with expected 0xff
+tru11_result tru11_session::blank_check(uint16_t arg_addr, uint32_t arg_len){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	if(!check_range(arg_addr, arg_len, &result)){
+		return result;
+	}
+	call_params.from_addr = arg_addr;
+	call_params.to_addr = arg_addr + arg_len - 1;
+	call_params.use_all = false;
+	run(CMD_BLANK_CHECK, &call_params, &result);
+
+	return result;
+}
+
+// Tests memory from arg_addr, RAM with a March test or with params.use_ee the EEPROM cells, see memtest().  The
+// failures are the mismatches
+tru11_result tru11_session::memtest(uint16_t arg_addr, uint32_t arg_len){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	if(!check_range(arg_addr, arg_len, &result)){
+		return result;
+	}
+	call_params.from_addr = arg_addr;
+	call_params.to_addr = arg_addr + arg_len - 1;
+	run(CMD_MEMTEST, &call_params, &result);
+
+	return result;
+}
+
+// Writes the hex string routine at arg_addr, unless it is empty, then calls it with arg_regs.  The registers it
+// returns with are result.regs
+tru11_result tru11_session::call(uint16_t arg_addr, std::string arg_hex, talker_regs arg_regs){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	call_params.from_addr = arg_addr;
+	call_params.data = arg_hex;
+	call_params.reg_a = arg_regs.a;
+	call_params.reg_b = arg_regs.b;
+	call_params.reg_y = arg_regs.y;
+	run(CMD_CALL, &call_params, &result);
+
+	return result;
+}
+
+// Writes and verifies a S-record file, arg_cmd is CMD_WRITE_NORMAL, CMD_WRITE_EE, CMD_WRITE_E or CMD_WRITE_E20.  There
+// is no programming confirmation, for EPROM the caller applies the programming voltage first
+tru11_result tru11_session::write(cmd_type arg_cmd, std::string arg_file_name){
+	cl_my_params call_params = params;
+	tru11_result result = {};
+
+	if(arg_cmd != CMD_WRITE_NORMAL && arg_cmd != CMD_WRITE_EE && arg_cmd != CMD_WRITE_E && arg_cmd != CMD_WRITE_E20){
+		tru_exception ex(__func__, TRU_EXCEPT_SRC_VEN, APP_ERROR_SESSION_CMD_ID, app_error_string::messages[APP_ERROR_SESSION_CMD_ID], "");
+		set_result_error(&result, ex);
+		return result;
+	}
+
+	call_params.full_file_name = arg_file_name;
+	run(arg_cmd, &call_params, &result);
+
+	return result;
+}
@@ -0,0 +1,51 @@
+#ifndef TRU11_LIB_H
+#define TRU11_LIB_H
+
+#include "cmd_line.h"
+#include "serial_com.h"
+#include "talker.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+
+// Result of a session call
+typedef struct{
+	bool is_passed;  // Verify or write matched, programming is not confirmed here so there is no declined
+	std::vector<uint8_t> bytes;  // Bytes read
+	std::vector<mem_mismatch> mismatches;
+	uint32_t elapsed_ms;
+	uint32_t estimate_ms;  // Predicted by the time model, much less than elapsed_ms points to the adapter or cable
+	std::string log;  // What the command line program prints for the command
+	talker_regs regs;  // Registers a called routine returned with
+	size_t error_code;  // 0, or the code of the error the call stopped at (the command line program's exit code)
+	std::string error;  // The error as tru_exception::get_error(), the log and results are what was done before it
+}tru11_result;
+
+bool run_talker_cmd(cl_my_params *arg_params, serial_com *arg_serial_com, std::function<bool(uint8_t arg_write_cmd_code)> arg_confirm, talker_regs *arg_regs);
+
+// A talker session for a program that builds in the Tru11 sources instead of running tru11 for each step.  Each session
+// has its own serial COM port and output, so several can run in one process.  open() throws a tru_exception, the calls
+// return their error in the result with the partial log
+class tru11_session{
+protected:
+	serial_com _serial;
+	bool check_range(uint16_t arg_addr, uint32_t arg_len, tru11_result *arg_result);
+	void run(cmd_type arg_cmd, cl_my_params *arg_call_params, tru11_result *arg_result);
+
+public:
+	cl_my_params params;  // Options, the same as the command line parameters, e.g. params.use_block for block=y
+	std::function<void(uint32_t arg_done, uint32_t arg_total)> on_progress;  // Bytes done of the read range or file
+
+	void open(std::string arg_dev_path);
+	void close();
+	tru11_result upload_talker();
+	tru11_result read(uint16_t arg_addr, uint32_t arg_len);
+	tru11_result verify(std::string arg_file_name);
+	tru11_result blank_check(uint16_t arg_addr, uint32_t arg_len);
+	tru11_result memtest(uint16_t arg_addr, uint32_t arg_len);
+	tru11_result call(uint16_t arg_addr, std::string arg_hex, talker_regs arg_regs);
+	tru11_result write(cmd_type arg_cmd, std::string arg_file_name);
+};
+
+#endif
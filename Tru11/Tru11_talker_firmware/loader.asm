@@ -0,0 +1,126 @@
+; MIT License
+;
+; Copyright (c) 2024 Truong Hy
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in all
+; copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+; SOFTWARE.
+
+; Stage 1 loader firmware for a two-stage boot
+;
+; Description
+; ===========
+;
+; A tiny program downloaded by the bootloader instead of the talker. It switches
+; the SCI to 9600 baud (the fastest standard baud rate with an 8MHz xtal), then
+; receives the talker (stage 2) and jumps to it. This is faster than sending the
+; talker to the bootloader at 1200 baud.  For another crystal the host patches
+; the BAUD register value at $0001 (BaudVal) before the upload.
+;
+; The load loop is first copied to the top of RAM, so the talker can be loaded
+; over this program at address $0000.  The top of RAM is therefore not
+; available to the talker while loading, the host sends the rest of a larger
+; talker to the talker itself once it is running.
+;
+; Special test mode is switched on, so the talker may also be loaded into
+; external memory.
+;
+; Communication flow
+; ==================
+;
+; 1. Host sends low byte of start load address
+; 2. Host sends high byte of start load address
+; 3. Host sends low byte of end load address (the address after the last byte)
+; 4. Host sends high byte of end load address
+; 5. Host sends byte of the talker, MCU stores it and replies with the byte (reread)
+; 6. MCU increments load address, repeat from 5 until the end address
+; 7. MCU jumps to the start load address
+
+; RAM size options, must be the same as the host ram= option
+;RamSize     EQU 256                   ; for A and 811E2 (not useful, the talker does not fit with the loader)
+RamSize      EQU 512                   ; for E0, E1, E9
+;RamSize     EQU 768                   ; for E20
+;RamSize     EQU 1024                  ; for F1
+
+BaudDefault  EQU $30                   ; 9615 baud with an 8MHz crystal, good enough to communicate at 9600 baud
+
+; Register address constants
+RegBase      EQU $1000                 ; Base address of memory mapped registers
+BAUD_OFS     EQU $2B
+SCSR_OFS     EQU $2E
+SCDR_OFS     EQU $2F
+HPRIO_OFS    EQU $3C
+
+; Bitmasks
+TDRE         EQU $80
+TC           EQU $40
+RDRF         EQU $20
+
+; Our own address constants, at the top of RAM above the copied load loop
+LoadEnd      EQU RamSize-2
+LoopAddr     EQU LoadEnd-LoopSize
+Stack        EQU LoopAddr-1            ; The load loop uses up to 4 bytes of stack below itself
+
+; Main
+; Initialisations
+             ORG  $0
+             LDAB #BaudDefault         ; B = BAUD register value, the host patches this operand for a crystal other than 8MHz
+BaudVal      EQU  *-1
+             LDS  #Stack               ; The bootloader's stack may be where the talker is loaded
+             LDX  #Loop                ; Copy the load loop to the top of RAM
+             LDY  #LoopAddr
+Copy         LDAA $00,X
+             STAA $00,Y
+             INX
+             INY
+             CPX  #LoopEnd
+             BNE  Copy
+             LDX  #RegBase             ; Load X register with the base address of memory mapped registers
+             LDAA #$66                 ; A = $66.  Value for HPRIO
+             STAA HPRIO_OFS,X          ; HPRIO ($103C) = A.  Switch to Special Test mode, this also enables access to external memory areas
+             BRCLR SCSR_OFS,X,#TC,*    ; Wait for the bootloader's last echo to finish
+             STAB BAUD_OFS,X           ; BAUD register ($102B) = $30 (Set 9612 baud with an 8MHz crystal)
+             JMP  LoopAddr
+
+; Load loop: copied to and run from the top of RAM, so must only use relative branches
+Loop         BSR  LoadRead             ; Read start load address from host, low byte first
+             TAB
+             BSR  LoadRead
+             XGDY                      ; Y = start load address
+             PSHY                      ; Save it as the return address for jumping to the talker
+             BSR  LoadRead             ; Read end load address from host, low byte first
+             TAB
+             BSR  LoadRead
+             STD  LoadEnd
+Load         CPY  LoadEnd
+             BEQ  LoadDone             ; Loop until end address
+             BSR  LoadRead             ; Read byte from host
+             STAA $00,Y                ; Store byte
+             LDAA $00,Y                ; Reread byte
+             BRCLR SCSR_OFS,X,#TDRE,*  ; Wait for transmit buffer empty
+             STAA SCDR_OFS,X           ; Send byte to host
+             INY                       ; Increment address
+             BRA  Load
+LoadDone     BRCLR SCSR_OFS,X,#TC,*    ; Wait for the last byte to finish sending
+             RTS                       ; Jump to the talker
+LoadRead     BRCLR SCSR_OFS,X,#RDRF,*  ; Wait for receive buffer full
+             LDAA SCDR_OFS,X           ; Read byte from host into A register
+             RTS
+LoopEnd
+LoopSize     EQU LoopEnd-Loop
+
+    END
@@ -29,9 +29,20 @@
 ; Enables host computer to control the MCU through the serial port in
 ; bootstrap mode.  Provides these controls:
 ; - read memory
+; - read memory run-length encoded
 ; - write normal memory
 ; - program EEPROM
 ; - program EPROM
+; - write compressed (run-length encoded) to normal memory, EEPROM or EPROM, needs more than 256 bytes of RAM
+; - program EPROM with adaptive verified pulses, needs more than 256 bytes of RAM
+; - write block, received into a RAM buffer at full line rate then written or programmed, needs more than 512 bytes of RAM
+; - checksum blocks of memory, so the host can fetch only the blocks that changed, needs more than 256 bytes of RAM
+; - framed, a command header checked with a CRC-16 before the command runs, needs more than 512 bytes of RAM
+; - call, a routine uploaded by the host is called with register arguments and its registers are sent back, so the
+;   host can run per-byte work at MCU speed, needs more than 512 bytes of RAM and MultiDrop not set
+; - multi-drop, several MCUs on one serial line that each reply only when addressed, with the SCI's 9-bit address
+;   mark wake-up, needs MultiDrop set and more than 512 bytes of RAM
+; - identify, so the host can check the talker is running
 ;
 ; Only need MODA + MODB tied to ground, serial pins TX+RX wired to a TTL serial
 ; adapter to host.
@@ -48,6 +59,18 @@
 ; 6. MCU sends byte of memory, increments read address and decrements byte count
 ; 7. Repeat from 6 until byte count is zero
 ;
+; Read memory run-length encoded command
+; 1. Host sends $06
+; 2. MCU replies with $06 (echo)
+; 3. Host sends byte count. A value from 0 to 255 (Note 0 = 256 bytes)
+; 4. Host sends high byte of start read address
+; 5. Host sends low byte of start read address
+; 6. MCU sends byte of memory, increments read address and decrements byte count
+; 7. If the next byte is the same, MCU sends it again followed by a repeat count of how
+;    many more times it appears (0 to 254), and skips over them
+; 8. Repeat from 6 until byte count is zero
+; Note, the host knows a repeat count follows whenever it receives two equal bytes in a row
+;
 ; Write normal memory (RAM or memory-mapped register) command
 ; 1. Host sends $02
 ; 2. MCU replies with $02 (echo)
@@ -86,22 +109,156 @@
 ; 6. Host sends byte of memory
 ; 7. MCU replies with byte programmed (reread)
 ; 8. MCU increments read address and decrements byte count, repeat from 6 until byte count is zero
+;
+; Write compressed command (only when RAM size is more than 256 bytes)
+; 1. Host sends $07
+; 2. MCU replies with $07 (echo)
+; 3. Host sends memory type: 0 = normal memory, 1 = EEPROM, 2 = EPROM, 3 = MC68HC711E20 EPROM
+; 4. Host sends byte count. A value from 0 to 255 (Note 0 = 256 bytes)
+; 5. Host sends high byte of start write address
+; 6. Host sends low byte of start write address
+; 7. Host sends byte of memory, MCU writes or programs it, increments write address and decrements byte count
+; 8. When programming (memory type is not 0), MCU replies with byte programmed (reread)
+; 9. If the byte is the same as the previous one, host sends a repeat count (0 to 254) after it, MCU writes or
+;    programs the byte that many more times, then replies with the low byte of the checksum so far
+; 10. Repeat from 7 until byte count is zero
+; 11. MCU replies with the high and low byte of the checksum (16-bit sum of all bytes reread)
+; Note, the host must wait for each reply before sending more, because programming is slower than the serial line
+;
+; Write EPROM adaptive command (only when RAM size is more than 256 bytes)
+; 1. Host sends $08
+; 2. MCU replies with $08 (echo)
+; 3. Host sends the offset of the EPROM programming register from $1000: $3B = PPROG, $36 = EPROG (MC68HC711E20)
+; 4. Host sends pulse width in 0.1ms units (1 to 255)
+; 5. Host sends maximum pulse count (1 to 255)
+; 6. Host sends byte count. A value from 0 to 255 (Note 0 = 256 bytes)
+; 7. Host sends high byte of start write address
+; 8. Host sends low byte of start write address
+; 9. Host sends byte of memory
+; 10. MCU applies a pulse and rereads the byte, repeating until it matches or the maximum pulse count is reached.
+;     When it matches, MCU applies an over-program margin pulse as long as all the pulses so far (count x width)
+; 11. MCU replies with byte programmed (reread), then the pulse count used
+; 12. MCU increments write address and decrements byte count, repeat from 9 until byte count is zero
+; Note, a byte that failed to program is replied with the maximum pulse count and a reread that does not match
+;
+; Write block command (only when RAM size is more than 512 bytes)
+; 1. Host sends $09
+; 2. MCU replies with $09 (echo)
+; 3. MCU replies with the size of its block buffer (Note 0 = 256 bytes)
+; 4. Host sends memory type: 0 = normal memory, 1 = EEPROM, 2 = EPROM, 3 = MC68HC711E20 EPROM
+; 5. Host sends byte count, up to the block buffer size (Note 0 = 256 bytes)
+; 6. Host sends high byte of start write address
+; 7. Host sends low byte of start write address
+; 8. Host sends all the bytes of the block without waiting, MCU stores them in the block buffer
+; 9. MCU writes or programs each byte from the block buffer, increments write address and decrements byte count
+; 10. MCU replies with the high and low byte of the checksum (16-bit sum of all bytes reread)
+;
+; Checksum command (only when RAM size is more than 256 bytes)
+; 1. Host sends $0A
+; 2. MCU replies with $0A (echo)
+; 3. Host sends block count. A value from 0 to 255 (Note 0 = 256 blocks)
+; 4. Host sends block size. A value from 0 to 255 (Note 0 = 256 bytes)
+; 5. Host sends high byte of start address
+; 6. Host sends low byte of start address
+; 7. MCU replies with the high and low byte of the checksum of a block, and increments the address by the block size
+; 8. Repeat from 7 until block count is zero
+; Note, the checksum is Fletcher style: the low byte is the sum of the bytes and the high byte the sum of the
+; low byte after each byte, both modulo 256, so unlike a plain sum it also changes when bytes move
+;
+; Framed command (only when RAM size is more than 512 bytes)
+; 1. Host sends $0B
+; 2. MCU replies with $0B (echo)
+; 3. Host sends a sequence number
+; 4. Host sends the command to run: $01 to $06 or $0A
+; 5. Host sends byte count. A value from 0 to 255 (Note 0 = 256 bytes)
+; 6. Host sends high byte of start address
+; 7. Host sends low byte of start address
+; 8. Host sends the high and low byte of the CRC-16 of 3 to 7 (CCITT polynomial $1021, initial value $FFFF)
+; 9. If the CRC matches, MCU replies with the sequence number (ACK) and runs the command without its echo, with the
+;    byte count and address from the header. Else MCU replies with the complement of the sequence number (NAK)
+; Note, any other parameters of the command still come from the host, e.g. the block count of the checksum command
+;
+; Multi-drop command (only when assembled with MultiDrop set)
+; 1. Host sends $0C
+; 2. MCU replies with $0C (echo)
+; 3. Host sends a byte count, not used
+; 4. Host sends high byte of the location of this MCU's unit address, e.g. $100A for port E strapped on each board
+; 5. Host sends low byte of the location of the unit address
+; 6. MCU reads its unit address (1 to 254), switches the SCI to 9 data bits with address mark wake-up and sleeps
+; 7. Host sends an address byte with the ninth bit set (host mark parity), all other bytes have it clear (space parity):
+;    - a unit address: that MCU wakes up and runs the commands that follow, the others sleep
+;    - $00 followed by a lead unit address: all MCUs run the commands that follow, only the lead replies
+;    - $FF: all MCUs leave multi-drop and return to 8 data bits
+; Note, the bootloader leaves port D in wired-OR mode, so the TxD pins of the MCUs may be joined with a pull-up, an
+; MCU that does not reply leaves its TxD released.  All MCUs must have the same crystal, a broadcast is paced by the
+; lead's replies
+;
+; Call command (only when RAM size is more than 512 bytes and MultiDrop is not set)
+; 1. Host sends $0D
+; 2. MCU replies with $0D (echo)
+; 3. Host sends register A
+; 4. Host sends high byte of the routine address
+; 5. Host sends low byte of the routine address
+; 6. Host sends register B
+; 7. Host sends high byte of register Y
+; 8. Host sends low byte of register Y
+; 9. MCU calls the routine (JSR) with A, B, Y, and X = the routine address
+; 10. When the routine returns, MCU replies with A, B, then the high and low byte of Y
+; Note, the routine is uploaded with the write memory command, e.g. to the top of the block buffer below the stack.
+; It must return with RTS and leave the stack as it was, X may be changed.  Only the reply ends the command, so the
+; host's timeout must allow for the routine's run time
+;
+; Identify command
+; 1. Host sends $FF
+; 2. MCU replies with $FF (echo)
+; 3. MCU replies with the talker version
+; 4. MCU replies with the RAM size the talker was assembled for, divided by 256
+; Note, $FF is used because at 9600 baud it is only one short low pulse, which the bootloader ignores at 1200 baud
+;
+; Timing parameters
+; =================
+;
+; The talker is assembled for an 8MHz crystal. For another crystal the host patches these operands of the
+; initialisation code before the upload, at fixed addresses:
+; $0002-$0003 DelayCnt: 10ms delay count, E clock cycles in 10ms / 6
+; $000D       BaudVal:  BAUD register value
+; $001A       PulseCnt: 0.1ms adaptive EPROM pulse unit count, (E clock cycles in 0.1ms - 8) / 5 (RAM size more than 256 bytes)
+; DelayCnt and PulseCnt stay in RAM, so the host may also change them later with the write memory command
+
+; RAM size options, the top of RAM is used for the stack. When more than 256, upload with the host ram= option set to it
+RamSize      EQU 256                   ; for A and 811E2
+;RamSize     EQU 512                   ; for E0, E1, E9
+;RamSize     EQU 768                   ; for E20
+;RamSize     EQU 1024                  ; for F1
+Stack        EQU RamSize-1
+RamOver512   EQU RamSize/768           ; Not 0 when RAM size is more than 512 bytes, for IF outside the RAM size sections
 
-; Stack options at top of RAM
-Stack        EQU $00FF                 ; for A and 811E2
-;Stack       EQU $01FF                 ; for E0, E1, E9
-;Stack       EQU $02FF                 ; for E20
-;Stack       EQU $03FF                 ; for F1
+; Multi-drop option, needs more than 512 bytes of RAM.  With 768 it leaves only a few bytes for the block buffer
+MultiDrop    EQU 0
+;MultiDrop   EQU 1
+
+; Talker version, sent by the identify command
+Version      EQU $01
 
 ; Counter value for 10ms delay when using 8MHz xtal
 ; The delay loop (excluding call, setup and return) takes 6 cycles (DEX = 3 & BNE = 3), so with an 8 MHz crytal and 2 MHz E clock (0.5us),
 ; the loop time is 6 * 0.5us = 3us, so a counter value for a delay of 10 ms is: 10ms*1000/3us = 10000/3 = 3333 (truncated)
 DelayAmt     EQU 10000/3
+BaudDefault  EQU $30                   ; 9615 baud with an 8MHz crystal, good enough to communicate at 9600 baud
+
+; Counter value for a 0.1ms unit of the adaptive EPROM pulse when using 8MHz xtal
+; The inner loop takes 5 cycles (DECB = 2 & BNE = 3) = 2.5us, the outer loop adds 8 cycles (LDAB = 2, DEX = 3 & BNE = 3) = 4us,
+; so the counter value is (100us-4us)/2.5us = 38 (truncated)
+PulseUnitAmt EQU 38
 
 ; Register address constants
 RegBase      EQU $1000                 ; Base address of memory mapped registers
 BAUD_OFS     EQU $2B
 SCCR1_OFS    EQU $2C
+SCCR1_R8     EQU $80                   ; Received ninth bit
+SCCR1_M      EQU $10                   ; 9 data bits
+SCCR1_WAKE   EQU $08                   ; Address mark wake-up
+SCCR2_RWU    EQU $02                   ; Receiver asleep until an address byte
 SCCR2_OFS    EQU $2D
 SCSR_OFS     EQU $2E
 SCDR_OFS     EQU $2F
@@ -119,36 +276,120 @@ EEBulkErase  EQU $06
 EEByteProg   EQU $02
 EByteProg    EQU $20
 
-; Our own address constants
+; Our own address constants (reuse the initialisation code area, except for the timing parameters)
 EEOpt        EQU $0000
+RleCnt       EQU $0001                 ; Byte count at start of a run
+ZPrev        EQU $0004                 ; Previous byte received by write compressed
+ZRunCnt      EQU $0005                 ; Repeat count of write compressed
+ZSum         EQU $0006                 ; 16-bit checksum of write compressed
+EByte        EQU $0008                 ; Byte being programmed by write EPROM adaptive
+EPulseW      EQU $0009                 ; Pulse width in 0.1ms units
+EPulseMax    EQU $000A                 ; Maximum pulse count
+EPReg        EQU $000B                 ; Offset of the EPROM programming register
+BPtr         EQU $000C                 ; Block buffer pointer of write block
+SumCnt       EQU $000E                 ; Block count of checksum
+SumBlk       EQU $000F                 ; Block size of checksum
+SumLeft      EQU $0010                 ; Bytes left in the block of checksum
+FHdr         EQU $0011                 ; Header of framed
+FSeq         EQU FHdr                  ; Sequence number
+FCmd         EQU FHdr+1                ; Command
+FCount       EQU FHdr+2                ; Byte count
+FAddr        EQU FHdr+3                ; Address
+FFlag        EQU $0018                 ; Not 0 when the command parameters are from the framed header
+MState       EQU $0019                 ; Multi-drop state
+MDropOn      EQU $80                   ; MState bit, in multi-drop mode
+MQuiet       EQU $01                   ; MState bit, this MCU does not reply
+BlockStack   EQU 16                    ; Stack space kept below the top of RAM, the block buffer is between the code and it
 
 ; Main
 ; Initialisations
              ORG  $0
+             LDY  #DelayAmt            ; Y is not used, the operand is the DelayCnt timing parameter
+DelayCnt     EQU  *-2
              LDS  #Stack               ; Load stack pointer
              LDX  #RegBase             ; Load X register with the base address of memory mapped registers
              CLR  SCCR1_OFS,X          ; SCCR1 register: ($102C) = $00. Together with next few lines, initialise SCI + BAUD registers for 8 data bits, 9600 baud
-             LDD  #$300C               ; D register = $300C. A register = $30, B register = $0C
+             LDD  #BaudDefault*256+$0C ; D register = $300C. A register = $30, B register = $0C
+BaudVal      EQU  *-2
              STAA BAUD_OFS,X           ; Store A into BAUD register: ($102B) = $30 (Set 9612 baud with an 8MHz crystal, good enough to communicate at 9600 baud)
              STAB SCCR2_OFS,X          ; Store B into SCCR2 register: ($102D) = $0C
              CLR  BPROT_OFS,X          ; Clear the block protect register (BPROT), which allows EEPROM programming
              LDAA #$66                 ; A = $66.  Value for HPRIO
              STAA HPRIO_OFS,X          ; HPRIO ($103C) = A.  Switch to Special Test mode, RBOOT = 0, IRV = 0.  This enables config register programming and also access to external memory areas
+             IF RamSize-256
+             LDAB #PulseUnitAmt        ; B is not used, the operand is the PulseCnt timing parameter
+PulseCnt     EQU  *-1
+             ENDIF
 
 ; Command input loop: Wait for command from host loop
-ReadCmd      CLR EEOpt
+ReadCmd
+             IF RamOver512
+             CLR FFlag                 ; Parameters from the host
+             IF MultiDrop
+             TST MState
+             BPL ReadCmdSer
+             JMP MReadCmd              ; Multi-drop, the byte may be an address
+ReadCmdSer
+             ENDIF
+             JSR ReadEchoSerA
+             ELSE
              BSR ReadEchoSerA
-             CMPA #$01
-             BEQ ReadMemCmd
-             CMPA #$02
-             BEQ WriteMemCmd
+             ENDIF
+Dispatch     INCA
+             BEQ IdentCmd              ; $FF
+             SUBA #$02                 ; Count down the command number (smaller code than comparing with each one)
+             BEQ ReadMemCmd            ; $01
+             DECA
              CMPA #$03
-             BEQ WriteEECmd
-             CMPA #$04
-             BEQ WriteECmd
-             CMPA #$05
-             BEQ WriteE20Cmd
-             BRA ReadCmd               ; Loop when no command
+             BLS WriteMemCmd           ; $02 to $05, A = EEOpt
+             SUBA #$04
+             IF RamSize-256
+             BEQ RleReadJmp
+             DECA
+             BEQ ZWriteJmp
+             DECA
+             BEQ EWriteJmp
+             DECA
+             IF RamSize-512
+             BEQ BWriteJmp
+             ENDIF
+             DECA
+             IF RamSize-512
+             BEQ SumJmp
+             DECA
+             BEQ FrameJmp
+             DECA
+             IF MultiDrop
+             BNE ReadCmd               ; Loop when no command
+             JMP MDropCmd              ; $0C
+             ELSE
+             DECA                      ; $0C is the multi-drop command
+             BNE ReadCmd               ; Loop when no command
+             JMP CallCmd               ; $0D
+             ENDIF
+FrameJmp     JMP FrameCmd              ; $0B
+SumJmp
+             ELSE
+             BNE ReadCmd               ; Loop when no command
+             ENDIF
+             JMP SumCmd                ; $0A
+             IF RamSize-512
+BWriteJmp    JMP BWriteCmd             ; $09
+             ENDIF
+EWriteJmp    JMP EWriteCmd             ; $08
+ZWriteJmp    JMP ZWriteCmd             ; $07
+RleReadJmp
+             ELSE
+             BNE ReadCmd               ; Loop when no command
+             ENDIF
+             JMP RleReadCmd            ; $06
+
+; Identify command: Send talker version and RAM size to host
+IdentCmd     LDD #Version*256+RamSize/256
+             BSR WriteSerA             ; Send version to host
+             TBA
+             BSR WriteSerA             ; Send RAM size / 256 to host
+             BRA ReadCmd
 
 ; Read command: Read memory and send to host
 ReadMemCmd   BSR MemParams
@@ -157,36 +398,40 @@ ReadMem      LDAA $00,Y                ; Read memory value into A reg
              INY                       ; Increment address
              DECB                      ; Decrement byte count
              BNE ReadMem               ; Loop until all bytes done
-             JMP ReadCmd
+             BRA ReadCmd
 
 ; EEOpt: 3 = E20 EPROM, 2 = EPROM, 1 = EEPROM, 0 = Normal memory
 
-; Write EPROM E20 command
-WriteE20Cmd  INC EEOpt
-
-; Write EPROM command
-WriteECmd    INC EEOpt
-
-; Write EEPROM command
-WriteEECmd   INC EEOpt
-
-; Write command: Receive byte from host then write normal memory or program EEPROM/EPROM
-WriteMemCmd  BSR MemParams
+; Write, write EEPROM, write EPROM and write EPROM E20 commands: Receive byte from host then write normal memory or program EEPROM/EPROM
+WriteMemCmd  STAA EEOpt                ; EEOpt = command - 2
+             BSR MemParams
 WriteMem     BRCLR SCSR_OFS,X,#RDRF,*  ; Wait for receive buffer full
              LDAA SCDR_OFS,X           ; Read byte from host into A register, then below echo back to host
-             TST EEOpt
-             BEQ NoProg                ; If EEOpt = 0 or negative then NoProg
-             JMP Prog                  ; Program byte to EEPROM
-NoProg       STAA $00,Y                ; Write to memory
-ProgReturn   LDAA $00,Y                ; Reread memory
+             BSR WriteByte             ; Write or program byte, and reread it
              BSR WriteSerA             ; Send byte to host
              INY                       ; Increment address
              DECB                      ; Decrement byte count
              BNE WriteMem              ; Loop until all bytes done
-             JMP ReadCmd
+             BRA ReadCmd
+
+; Write normal memory or program EEPROM/EPROM, then reread memory. Y = address, A = byte to write
+WriteByte    TST EEOpt
+             BNE Prog                  ; If EEOpt is not 0 then program byte
+             STAA $00,Y                ; Write to memory
+ProgReturn   LDAA $00,Y                ; Reread memory
+             RTS
 
 ; Read memory parameters from host
-MemParams    BSR ReadSerB              ; Read byte count from host
+MemParams
+             IF RamOver512
+             TST FFlag
+             BEQ MemSerial
+             LDAB FCount               ; Framed, byte count and address from the header
+             LDY FAddr
+             RTS
+MemSerial
+             ENDIF
+             BSR ReadSerB              ; Read byte count from host
              XGDY                      ; Save command & byte count to IY reg
              BSR ReadSerB              ; Read high byte of address from host
              TBA                       ; Transfer high byte to A reg
@@ -204,17 +449,20 @@ ReadEchoSerA BRCLR SCSR_OFS,X,#RDRF,*  ; Wait for receive buffer full
              LDAA SCDR_OFS,X           ; Read byte from host into A register, then below echo back to host
 
 ; Write serial
-WriteSerA    BRCLR SCSR_OFS,X,#TDRE,*  ; Wait for transmit buffer empty
+WriteSerA
+             IF MultiDrop
+             BRSET MState,#MQuiet,WriteSerEnd ; Multi-drop, only the selected MCU or the broadcast lead replies
+             ENDIF
+             BRCLR SCSR_OFS,X,#TDRE,*  ; Wait for transmit buffer empty
              STAA SCDR_OFS,X           ; Write byte from A register to host
-             RTS
+WriteSerEnd  RTS
 
 ; Program EEPROM or EPROM. Y = address, A = byte to program
 Prog         PSHB                       ; Save B reg
              LDAB EEOpt
-             CMPB #$03
-             BEQ DoE20Prog
              CMPB #$02
              BEQ DoEProg
+             BHI DoE20Prog
 EEErase      LDAB #EEByteErase          ; Set default byte erase mode
              CPY #CONFIG                ; If address is CONFIG then bulk erase
              BNE ProgDefault
@@ -223,7 +471,7 @@ ProgDefault  BSR DoProg                 ; Byte erase or bulk erase + CONFIG
              LDAB #EEByteProg           ; Set program mode
              BSR DoProg                 ; Program byte
 ProgExit     PULB                       ; Restore B reg
-             JMP ProgReturn
+             BRA ProgReturn
 DoEProg      LDAB #EByteProg            ; Set program mode
              BSR DoProg                 ; Program byte
              BRA ProgExit
@@ -241,10 +489,301 @@ DoE20Prog    LDAB #EByteProg            ; Set program mode
              CLR EPROG_OFS,X            ; Disable internal programming voltage and release internal addr/data latches
              BRA ProgExit
 Delay        PSHX
-             LDX #DelayAmt              ; Delay amount
+             LDX DelayCnt               ; Delay amount
 Wait         DEX
              BNE Wait
              PULX
              RTS
 
+; Read run-length encoded command: Read memory and send to host, a repeated byte is sent twice followed by a repeat count
+RleReadCmd   BSR MemParams
+RleRead      LDAA $00,Y                ; Read memory value into A reg
+             BSR WriteSerA             ; Send byte to host
+             INY                       ; Increment address
+             DECB                      ; Decrement byte count
+             BEQ RleExit               ; Exit when all bytes done
+             CMPA $00,Y                ; Is the next byte the same?
+             BNE RleRead               ; No, send it normally
+             BSR WriteSerA             ; Send byte again to mark a run
+             STAB RleCnt               ; Save byte count at start of run
+RleRun       INY                       ; Increment address
+             DECB                      ; Decrement byte count
+             BEQ RleCount              ; Send repeat count when all bytes done
+             CMPA $00,Y                ; Is the next byte the same?
+             BEQ RleRun                ; Yes, skip over it
+RleCount     LDAA RleCnt               ; Repeat count = byte count at start of run - current byte count - 1
+             SBA
+             DECA
+             BSR WriteSerA             ; Send repeat count to host
+             TSTB
+             BNE RleRead               ; Loop until all bytes done
+RleExit      JMP ReadCmd
+
+             IF RamSize-256
+; Write compressed command: Receive run-length encoded bytes from host then write normal memory or program EEPROM/EPROM
+ZWriteCmd    JSR ReadSerB              ; Read memory type from host
+             STAB EEOpt                ; EEOpt = memory type
+             JSR MemParams
+             CLR ZSum                  ; Clear checksum
+             CLR ZSum+1
+ZWrite       BSR ZReadSerA             ; Read byte from host
+ZLiteral     STAA ZPrev                ; Save byte for comparing with the next one
+             BSR ZPut                  ; Write byte
+             TST EEOpt
+             BEQ ZNoReply              ; Only reply for each byte when programming
+             JSR WriteSerA             ; Send byte programmed to host
+ZNoReply     TSTB
+             BEQ ZDone                 ; Exit when all bytes done
+             BSR ZReadSerA             ; Read next byte from host
+             CMPA ZPrev                ; Is it the same as the previous byte?
+             BNE ZLiteral              ; No, write it normally
+             BSR ZPut                  ; Write byte again, a repeat count follows
+             BSR ZReadSerA             ; Read repeat count from host
+             INCA
+             STAA ZRunCnt              ; ZRunCnt = repeat count + 1
+ZRun         DEC ZRunCnt
+             BEQ ZRunDone              ; Loop until all repeats done
+             LDAA ZPrev
+             BSR ZPut                  ; Write repeated byte
+             BRA ZRun
+ZRunDone     LDAA ZSum+1               ; Send low byte of checksum to host
+             JSR WriteSerA
+             TSTB
+             BNE ZWrite                ; Loop until all bytes done
+ZDone        BSR SendSum               ; Send checksum to host
+             JMP ReadCmd
+
+; Send the high and low byte of the checksum to host
+SendSum      LDAA ZSum
+             JSR WriteSerA
+             LDAA ZSum+1
+             JMP WriteSerA
+
+; Write byte for write compressed and add the reread byte to the checksum. Y = address, A = byte to write
+ZPut         JSR WriteByte             ; Write or program byte, and reread it
+             PSHA
+             ADDA ZSum+1               ; Add reread byte to checksum
+             STAA ZSum+1
+             BCC ZPutNoCarry
+             INC ZSum
+ZPutNoCarry  PULA
+             INY                       ; Increment address
+             DECB                      ; Decrement byte count
+             RTS
+
+; Read serial no echo
+ZReadSerA    BRCLR SCSR_OFS,X,#RDRF,*  ; Wait for receive buffer full
+             LDAA SCDR_OFS,X           ; Read byte from host into A register
+             RTS
+
+; Checksum command: Send the checksum of each block of a memory range to host
+SumCmd       BSR ZReadSerA             ; Read block count from host
+             STAA SumCnt
+             JSR MemParams             ; B = block size
+             STAB SumBlk
+SumBlock     LDAA SumBlk
+             STAA SumLeft
+             CLRA                      ; D = checksum, A = high byte, B = low byte
+             CLRB
+SumByte      ADDB $00,Y                ; Add memory value to the low byte
+             ABA                       ; Add the low byte to the high byte
+             INY                       ; Increment address
+             DEC SumLeft
+             BNE SumByte               ; Loop until the block is done
+             STD ZSum
+             BSR SendSum               ; Send checksum of the block to host
+             DEC SumCnt
+             BNE SumBlock              ; Loop until all blocks done
+             JMP ReadCmd
+
+; Write EPROM adaptive command: Receive bytes from host and program each one with short pulses until it verifies,
+; followed by an over-program margin pulse
+EWriteCmd    BSR ZReadSerA             ; Read programming register offset from host
+             STAA EPReg                ; EPReg = PPROG or EPROG offset
+             BSR ZReadSerA             ; Read pulse width from host
+             STAA EPulseW
+             BSR ZReadSerA             ; Read maximum pulse count from host
+             STAA EPulseMax
+             JSR MemParams
+EWrite       BSR ZReadSerA             ; Read byte from host
+             STAA EByte
+             PSHB                      ; Save byte count
+             CLRB                      ; B = pulse count
+EPulse       INCB                      ; Count pulses
+             LDAA #1
+             BSR EProgPulse            ; Apply a pulse of 1 x width
+             LDAA $00,Y                ; Reread memory
+             CMPA EByte
+             BEQ EMargin               ; Verified
+             CMPB EPulseMax
+             BNE EPulse                ; Retry until the maximum pulse count
+             BRA EReply                ; Failed, no margin pulse
+EMargin      TBA
+             BSR EProgPulse            ; Apply the over-program margin pulse of pulse count x width
+EReply       LDAA $00,Y                ; Send byte programmed (reread) to host
+             JSR WriteSerA
+             TBA                       ; Send pulse count to host
+             JSR WriteSerA
+             PULB                      ; Restore byte count
+             INY                       ; Increment address
+             DECB                      ; Decrement byte count
+             BNE EWrite                ; Loop until all bytes done
+             JMP ReadCmd
+; Apply an EPROM programming pulse of A x width. Y = address, B is preserved
+EProgPulse   PSHB
+             PSHX
+             PSHA
+             LDAB EPReg
+             ABX                       ; X = programming register
+             LDAB #EByteProg
+             STAB $00,X                ; Enable internal addr/data latches
+             LDAA EByte
+             STAA $00,Y                ; Write byte to address
+             INC $00,X                 ; Enable internal programming voltage
+             PULA
+             LDAB EPulseW
+             MUL                       ; D = pulse width in 0.1ms units
+             PSHX
+             XGDX                      ; X = pulse width counter
+EPulseWait   LDAB PulseCnt             ; Delay 0.1ms
+EPulseUnit   DECB
+             BNE EPulseUnit
+             DEX
+             BNE EPulseWait
+             PULX
+             CLR $00,X                 ; Disable internal programming voltage and release internal addr/data latches
+             PULX
+             PULB
+             RTS
+             IF RamSize-512
+; Framed command: Receive a header checked with a CRC-16, then run the command in it
+FrameCmd     LDD #$FFFF                ; CRC initial value
+             STD ZSum                  ; ZSum = CRC
+             LDY #FHdr
+             LDAB #7                   ; Header and CRC byte count
+FRecv        JSR ZReadSerA             ; Read byte from host into the header
+             BSR CrcAdd
+             STAA $00,Y
+             INY
+             DECB
+             BNE FRecv                 ; Loop until all bytes received
+             LDAA FSeq
+             LDY ZSum                  ; The CRC of the header followed by its CRC is 0
+             BEQ FAck
+             COMA                      ; NAK, send the complement of the sequence number to host
+             JSR WriteSerA
+             JMP ReadCmd
+FAck         JSR WriteSerA             ; ACK, send the sequence number to host
+             INC FFlag                 ; Parameters from the header
+             LDAA FCmd
+             JMP Dispatch
+; Add A to the CRC-16 in ZSum, A and B are preserved
+CrcAdd       PSHA
+             PSHB
+             PSHX
+             EORA ZSum
+             LDAB ZSum+1
+             LDX #8                    ; Bit count
+CrcBit       LSLD
+             BCC CrcNext
+             EORA #$10                 ; CCITT polynomial $1021
+             EORB #$21
+CrcNext      DEX
+             BNE CrcBit
+             STD ZSum
+             PULX
+             PULB
+             PULA
+             RTS
+; Write block command: Receive a block from host into the block buffer, then write or program it
+BWriteCmd    LDAA #BlockReply          ; Send block buffer size to host
+             JSR WriteSerA
+             JSR ZReadSerA             ; Read memory type from host
+             STAA EEOpt                ; EEOpt = memory type
+             JSR MemParams
+             PSHY                      ; Save address and byte count
+             PSHB
+             LDY #BlockBuf
+             STY BPtr
+BRecv        JSR ZReadSerA             ; Read byte from host into the block buffer
+             STAA $00,Y
+             INY
+             DECB
+             BNE BRecv                 ; Loop until all bytes received
+             PULB                      ; Restore address and byte count
+             PULY
+             CLR ZSum                  ; Clear checksum
+             CLR ZSum+1
+BWrite       PSHY
+             LDY BPtr                  ; Load byte from the block buffer
+             LDAA $00,Y
+             INY
+             STY BPtr
+             PULY
+             JSR ZPut                  ; Write byte and add the reread byte to the checksum
+             TSTB
+             BNE BWrite                ; Loop until all bytes done
+             JMP ZDone                 ; Send checksum to host
+             IF MultiDrop
+; Multi-drop command: Read this MCU's unit address, then switch the SCI to 9 data bits with address mark wake-up and
+; sleep until an address byte selects it
+MDropCmd     JSR MemParams             ; Y = location of the unit address
+             LDAA $00,Y
+             STAA MUnit
+             LDAA #SCCR1_M+SCCR1_WAKE
+             STAA SCCR1_OFS,X          ; SCCR1 register: 9 data bits, wake-up on an address mark
+             LDAB #MDropOn
+             BRA MSleep
+; Multi-drop command input: An address byte (ninth bit set) selects the MCUs, else run the command
+MReadCmd     BRCLR SCSR_OFS,X,#RDRF,*  ; Wait for receive buffer full
+             BRSET SCCR1_OFS,X,#SCCR1_R8,MAddr
+             JMP ReadCmdSer            ; Not an address, read the command
+MAddr        LDAB #MDropOn             ; B = new state
+             LDAA SCDR_OFS,X           ; Read address from host
+             BEQ MBcast                ; $00, broadcast
+             CMPA MUnit
+             BEQ MSet                  ; This MCU is selected
+             INCA
+             BNE MSleep
+             CLR SCCR1_OFS,X           ; $FF, leave multi-drop.  SCCR1 register: 8 data bits
+             CLRB
+             BRA MSet
+MBcast       JSR ZReadSerA             ; Read the lead unit address from host, the only MCU that replies
+             CMPA MUnit
+             BEQ MSet
+             INCB                      ; Run the commands without replying
+             BRA MSet
+MSleep       INCB                      ; Not selected, do not reply and sleep until the next address byte
+             BSET SCCR2_OFS,X,#SCCR2_RWU
+MSet         STAB MState
+             JMP ReadCmd
+MUnit        FCB 0                     ; Unit address
+             ELSE
+; Call command: Call a routine uploaded by the host, then send its registers to host
+CallCmd      JSR MemParams             ; B = register A, Y = routine address
+             PSHX                      ; Save register base
+             PSHY
+             PSHB
+             JSR MemParams             ; B = register B, Y = register Y
+             PULA                      ; A = register A
+             PULX                      ; X = routine address
+             JSR $00,X                 ; Call the routine
+             PULX                      ; Restore register base
+             JSR WriteSerA             ; Send A to host
+             TBA
+             JSR WriteSerA             ; Send B to host
+             STY ZSum
+             JMP ZDone                 ; Send high and low byte of Y to host
+             ENDIF
+; Block buffer, from the end of the code up to the stack space
+BlockBuf
+BlockSize    EQU RamSize-BlockStack-BlockBuf
+             IF BlockSize/256
+BlockReply   EQU 0                     ; 256 bytes
+             ELSE
+BlockReply   EQU BlockSize
+             ENDIF
+             ENDIF
+             ENDIF
+
     END